@@ -0,0 +1,238 @@
+/*
+ * host/bench.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                 for the PicoSystem.
+ *
+ * This is the entry point for the host microbenchmarks; each of the per-frame
+ * hot functions is measured in isolation against a representative fixture,
+ * after a warm up, and reported as nanoseconds and pixels written per call.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "probe.hpp"
+#include "utils/scheduler.hpp"
+#include "utils/text.hpp"
+
+
+/* Constants. */
+
+#define BENCH_BATCHES   7
+#define BENCH_WARMUP    50
+
+
+/* Module variables. */
+
+static const char      *m_filter = nullptr;
+static uint32_t         m_batch_ms = 20;
+static volatile uint32_t m_sink;
+
+
+/* Functions. */
+
+/*
+ * now_ns - returns a monotonic nanosecond timestamp.
+ */
+
+static uint64_t now_ns( void )
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+/*
+ * bench - measures a single operation; it's warmed up, a batch size is picked
+ *         to fill the batch time, and the median of several batches is
+ *         reported along with the pixels written per operation.
+ */
+
+template <typename F>
+static void bench( const char *p_name, F &&p_op )
+{
+  uint64_t  l_ops, l_start_ns, l_elapsed_ns, l_pixels;
+  double    l_batch_ns[BENCH_BATCHES];
+
+  /* Skip anything that doesn't match the filter. */
+  if ( m_filter != nullptr && strstr( p_name, m_filter ) == nullptr )
+  {
+    return;
+  }
+
+  /* Warm up, and work out how many operations fill a batch. */
+  l_start_ns = now_ns();
+  for ( l_ops = 0; l_ops < BENCH_WARMUP; l_ops++ )
+  {
+    p_op();
+  }
+  l_elapsed_ns = now_ns() - l_start_ns;
+  l_ops = ( (uint64_t)m_batch_ms * 1000000 * BENCH_WARMUP ) / ( l_elapsed_ns ? l_elapsed_ns : 1 );
+  if ( l_ops == 0 )
+  {
+    l_ops = 1;
+  }
+
+  /* Run the batches, keeping track of pixel counts too. */
+  picosystem::_host_stats.pixels = 0;
+  for ( uint32_t l_batch = 0; l_batch < BENCH_BATCHES; l_batch++ )
+  {
+    l_start_ns = now_ns();
+    for ( uint64_t l_op = 0; l_op < l_ops; l_op++ )
+    {
+      p_op();
+    }
+    l_batch_ns[l_batch] = (double)( now_ns() - l_start_ns ) / l_ops;
+  }
+  l_pixels = picosystem::_host_stats.pixels;
+
+  /* Report the median batch. */
+  std::sort( l_batch_ns, l_batch_ns + BENCH_BATCHES );
+  printf( "%-32s %12.1f %12.1f %12llu\n", p_name, l_batch_ns[BENCH_BATCHES / 2],
+          (double)l_pixels / ( l_ops * BENCH_BATCHES ),
+          (unsigned long long)( l_ops * BENCH_BATCHES ) );
+}
+
+
+/*
+ * bench_game - the GameState benchmarks, over a full sheet, a half cleared
+ *              sheet and a full list of explosions.
+ */
+
+static void bench_game( void )
+{
+  GameState l_full, l_half, l_boom;
+
+  /* Set up the fixtures. */
+  StateProbe::clear_alternate( &l_half );
+  StateProbe::fill_explosions( &l_boom );
+
+  /* Update; explosions burn out, so that fixture is topped up every call. */
+  bench( "game.update/full", [&]() { m_sink += l_full.update( 25 ); } );
+  bench( "game.update/half", [&]() { m_sink += l_half.update( 25 ); } );
+  bench( "game.update/explosions", [&]() {
+    StateProbe::fill_explosions( &l_boom );
+    m_sink += l_boom.update( 25 );
+  } );
+
+  /* Draw doesn't change anything, so the fixtures stand as they are. */
+  StateProbe::fill_explosions( &l_boom );
+  bench( "game.draw/full", [&]() { l_full.draw(); } );
+  bench( "game.draw/half", [&]() { l_half.draw(); } );
+  bench( "game.draw/explosions", [&]() { l_boom.draw(); } );
+}
+
+
+/*
+ * bench_splash - the 1-bit logo loop, both part way through the fade and at
+ *                full brightness.
+ */
+
+static void bench_splash( void )
+{
+  SplashState l_fading, l_full;
+
+  StateProbe::set_splash_time( &l_fading, 250 );
+  StateProbe::set_splash_time( &l_full, 1000 );
+
+  bench( "splash.draw/fading", [&]() { l_fading.draw(); } );
+  bench( "splash.draw/full", [&]() { l_full.draw(); } );
+}
+
+
+/*
+ * bench_title - the title screen, with its blit, sprites and scaled text.
+ */
+
+static void bench_title( void )
+{
+  TitleState l_title;
+
+  StateProbe::set_title_time( &l_title, 1000 );
+  bench( "title.draw", [&]() { l_title.draw(); } );
+}
+
+
+/*
+ * bench_utils - the text and timer utilities.
+ */
+
+static void bench_utils( void )
+{
+  ScalableText  l_text( "PRESS X TO START", 1.5f );
+  TickScheduler l_scheduler;
+
+  picosystem::pen( 10, 15, 15, 10 );
+  bench( "text.set_text", [&]() { l_text.set_text( "PRESS X TO START" ); } );
+  bench( "text.draw", [&]() { l_text.draw( 48, 180 ); } );
+
+  /* The game's four timers, through a normal 25ms frame. */
+  l_scheduler.add( SCHEDULER_MS( 100 ) );
+  l_scheduler.add( SCHEDULER_MS( 10 ) );
+  l_scheduler.add( SCHEDULER_MS( 360 ) );
+  l_scheduler.add( SCHEDULER_MS( 20 ) );
+  bench( "scheduler.frame", [&]() {
+    l_scheduler.reset_counts();
+    l_scheduler.advance( SCHEDULER_MS( 25 ) );
+    while ( l_scheduler.next() != SCHEDULER_NONE )
+    {
+      m_sink++;
+    }
+  } );
+
+  /* Retiming, as the invaders speed up; every call changes the period. */
+  bench( "scheduler.set_period", [&]() {
+    l_scheduler.set_period( 2, SCHEDULER_MS( 17 ) + ( m_sink & 1 ) );
+    m_sink++;
+  } );
+}
+
+
+/*
+ * main - parses the command line, then runs the benchmarks.
+ */
+
+int main( int argc, char **argv )
+{
+  /* Work through the arguments. */
+  for ( int l_arg = 1; l_arg < argc; l_arg++ )
+  {
+    if ( strcmp( argv[l_arg], "--filter" ) == 0 && l_arg + 1 < argc )
+    {
+      m_filter = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--batch-ms" ) == 0 && l_arg + 1 < argc )
+    {
+      m_batch_ms = strtoul( argv[++l_arg], nullptr, 10 );
+    }
+    else
+    {
+      fprintf( stderr, "Usage: %s [--filter TEXT] [--batch-ms N]\n", argv[0] );
+      return 1;
+    }
+  }
+
+  /* Let the game set itself up, so the spritesheet is in place. */
+  init();
+
+  /* And then run everything. */
+  printf( "%-32s %12s %12s %12s\n", "benchmark", "ns/op", "pixels/op", "ops" );
+  bench_game();
+  bench_splash();
+  bench_title();
+  bench_utils();
+
+  /* All done. */
+  return 0;
+}
+
+
+/* End of file host/bench.cpp */
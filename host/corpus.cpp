@@ -0,0 +1,386 @@
+/*
+ * host/corpus.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This is the entry point for the replay corpus runner; every recording in
+ * the corpus is played back, hashing the simulation state every frame, and
+ * the hashes compared against the baseline stored alongside it. Any change in
+ * behaviour is reported with the first frame, and the fields, that diverged.
+ *
+ * Recordings can also have golden framebuffer hashes for selected frames, to
+ * check that the rendering is pixel-exact. Gameplay is also held to running
+ * without any heap allocations; strict mode aborts the run if it does.
+ *
+ * With the power governor on, frames that nothing has changed aren't drawn;
+ * the goldens must still match, as what's left on screen should be the same.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <dirent.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+
+/* Local headers. */
+
+#include "harness.hpp"
+#include "hashlog.hpp"
+#include "utils/clock.hpp"
+#include "utils/heap.hpp"
+#include "utils/power.hpp"
+#include "utils/replay.hpp"
+
+
+/* Constants. */
+
+#define CORPUS_DEFAULT_DIR  "host/corpus"
+#define CORPUS_REPLAY_EXT   ".pvr"
+#define CORPUS_HASH_EXT     ".hash"
+#define CORPUS_GOLDEN_EXT   ".golden"
+#define GOLDEN_HEADER       "# picovaders framebuffer goldens v1"
+
+
+/* Structures. */
+
+struct golden_t
+{
+  uint32_t      frame;
+  uint32_t      hash;
+};
+
+
+/* Module variables. */
+
+static const char  *m_dump_dir = nullptr;
+
+
+/* Functions. */
+
+/*
+ * load_goldens - reads a golden file; a list of frame numbers, and the hash
+ *                of the screen after that frame. Returns false if there isn't
+ *                a golden file to read.
+ */
+
+static bool load_goldens( const char *p_filename, std::vector<golden_t> &p_goldens )
+{
+  FILE     *l_file;
+  char      l_line[128], *l_cursor;
+  golden_t  l_golden;
+
+  l_file = fopen( p_filename, "r" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+  p_goldens.clear();
+  while ( fgets( l_line, sizeof( l_line ), l_file ) != nullptr )
+  {
+    if ( l_line[0] == '#' || l_line[0] == '\n' )
+    {
+      continue;
+    }
+    l_golden.frame = strtoul( l_line, &l_cursor, 10 );
+    l_golden.hash = strtoul( l_cursor, nullptr, 16 );
+    p_goldens.push_back( l_golden );
+  }
+  fclose( l_file );
+  return true;
+}
+
+
+/*
+ * save_goldens - writes the golden file back out.
+ */
+
+static bool save_goldens( const char *p_filename, const std::vector<golden_t> &p_goldens )
+{
+  FILE     *l_file;
+
+  l_file = fopen( p_filename, "w" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+  fprintf( l_file, "%s\n# frame framebuffer\n", GOLDEN_HEADER );
+  for ( const golden_t &l_golden : p_goldens )
+  {
+    fprintf( l_file, "%u %08x\n", l_golden.frame, l_golden.hash );
+  }
+  return fclose( l_file ) == 0;
+}
+
+
+/*
+ * replay_hashes - plays back a recording, hashing the state after every frame,
+ *                 and the screen for every golden frame. Returns false if the
+ *                 recording isn't valid.
+ */
+
+static bool replay_hashes( const char *p_filename, HashLog &p_log, std::vector<golden_t> &p_goldens )
+{
+  std::vector<uint8_t>  l_recording;
+  HostHarness           l_harness;
+  state_hash_t          l_hash;
+  uint32_t              l_frames;
+  std::string           l_dump_name;
+  char                  l_suffix[32];
+
+  /* Load the recording up. */
+  if ( !host_load_file( p_filename, l_recording ) )
+  {
+    return false;
+  }
+  InputPlayer l_player( l_recording.data(), l_recording.size() );
+  if ( !l_player.valid() )
+  {
+    return false;
+  }
+
+  /* And play it through, from a fresh start. */
+  l_frames = l_player.count_frames();
+  p_log.clear();
+  l_harness.set_paced( false );
+  l_harness.start();
+  set_input_player( &l_player );
+  for ( uint32_t l_frame = 0; l_frame < l_frames; l_frame++ )
+  {
+    l_harness.step();
+    StateProbe::hash_state( get_current_state(), l_hash );
+    p_log.add( l_hash );
+
+    /* Golden frames get their screen hashed, and maybe dumped too. */
+    for ( golden_t &l_golden : p_goldens )
+    {
+      if ( l_golden.frame != l_frame )
+      {
+        continue;
+      }
+      l_golden.hash = host_framebuffer_hash();
+      if ( m_dump_dir != nullptr )
+      {
+        l_dump_name = p_filename;
+        l_dump_name = l_dump_name.substr( l_dump_name.find_last_of( '/' ) + 1 );
+        snprintf( l_suffix, sizeof( l_suffix ), "_%05u.ppm", l_frame );
+        l_dump_name = std::string( m_dump_dir ) + "/" + l_dump_name + l_suffix;
+        host_save_ppm( l_dump_name.c_str() );
+      }
+    }
+  }
+  set_input_player( nullptr );
+
+  /* All done. */
+  return true;
+}
+
+
+/*
+ * compare - compares two hash logs, and reports where they diverge; returns
+ *           true if they match.
+ */
+
+static bool compare( const char *p_name, HashLog &p_baseline, HashLog &p_current )
+{
+  int64_t   l_frame;
+
+  l_frame = p_baseline.find_divergence( p_current );
+  if ( l_frame < 0 )
+  {
+    printf( "%-24s ok (%u frames)\n", p_name, p_current.get_length() );
+    return true;
+  }
+
+  /* Running out of frames is a simpler sort of difference. */
+  if ( l_frame >= p_baseline.get_length() || l_frame >= p_current.get_length() )
+  {
+    printf( "%-24s DIVERGED: %u frames, baseline has %u\n", p_name,
+            p_current.get_length(), p_baseline.get_length() );
+    return false;
+  }
+
+  /* Otherwise, work out which fields differ at the first diverging frame. */
+  const hash_frame_t &l_baseline = p_baseline.get_frame( l_frame );
+  const hash_frame_t &l_current = p_current.get_frame( l_frame );
+  printf( "%-24s DIVERGED at frame %lld:", p_name, (long long)l_frame );
+  for ( uint_fast8_t l_field = 0; l_field < HASH_FIELD_MAX; l_field++ )
+  {
+    if ( l_baseline.state.field[l_field] != l_current.state.field[l_field] )
+    {
+      printf( " %s (%08x, expected %08x)", hashlog_field_name( l_field ),
+              l_current.state.field[l_field], l_baseline.state.field[l_field] );
+    }
+  }
+  printf( "\n" );
+  return false;
+}
+
+
+/*
+ * compare_goldens - compares the screen hashes of a run with the goldens,
+ *                   reporting any that don't match; returns true if they all
+ *                   do.
+ */
+
+static bool compare_goldens( const char *p_name, const std::vector<golden_t> &p_expected,
+                             const std::vector<golden_t> &p_actual )
+{
+  bool l_match = true;
+
+  for ( uint32_t l_index = 0; l_index < p_expected.size(); l_index++ )
+  {
+    if ( p_expected[l_index].hash != p_actual[l_index].hash )
+    {
+      printf( "%-24s framebuffer differs at frame %u (%08x, expected %08x)\n", p_name,
+              p_expected[l_index].frame, p_actual[l_index].hash, p_expected[l_index].hash );
+      l_match = false;
+    }
+  }
+  if ( l_match )
+  {
+    printf( "%-24s ok (%u golden frames)\n", p_name, (uint32_t)p_expected.size() );
+  }
+  return l_match;
+}
+
+
+/*
+ * main - runs the corpus, or compares two hash logs directly.
+ */
+
+int main( int argc, char **argv )
+{
+  const char               *l_dir_name = CORPUS_DEFAULT_DIR;
+  bool                      l_update = false, l_pass = true;
+  DIR                      *l_dir;
+  struct dirent            *l_entry;
+  std::vector<std::string>  l_replays;
+  std::string               l_hash_name, l_golden_name;
+  HashLog                   l_baseline, l_current;
+  std::vector<golden_t>     l_goldens, l_expected;
+
+  /* Work through the arguments. */
+  for ( int l_arg = 1; l_arg < argc; l_arg++ )
+  {
+    if ( strcmp( argv[l_arg], "--dir" ) == 0 && l_arg + 1 < argc )
+    {
+      l_dir_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--update" ) == 0 )
+    {
+      l_update = true;
+    }
+    else if ( strcmp( argv[l_arg], "--governor" ) == 0 )
+    {
+      power_enable( true );
+    }
+    else if ( strcmp( argv[l_arg], "--dump" ) == 0 && l_arg + 1 < argc )
+    {
+      m_dump_dir = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--compare" ) == 0 && l_arg + 2 < argc )
+    {
+      if ( !l_baseline.load( argv[l_arg + 1] ) || !l_current.load( argv[l_arg + 2] ) )
+      {
+        fprintf( stderr, "Unable to read hash logs\n" );
+        return 1;
+      }
+      return compare( argv[l_arg + 2], l_baseline, l_current ) ? 0 : 1;
+    }
+    else
+    {
+      fprintf( stderr, "Usage: %s [--dir DIR] [--update] [--dump DIR] [--governor]\n", argv[0] );
+      fprintf( stderr, "       %s --compare BASELINE CURRENT\n", argv[0] );
+      return 1;
+    }
+  }
+
+  /* Find all the recordings in the corpus. */
+  l_dir = opendir( l_dir_name );
+  if ( l_dir == nullptr )
+  {
+    fprintf( stderr, "Unable to open corpus directory %s\n", l_dir_name );
+    return 1;
+  }
+  while ( ( l_entry = readdir( l_dir ) ) != nullptr )
+  {
+    std::string l_name = l_entry->d_name;
+    if ( l_name.size() > strlen( CORPUS_REPLAY_EXT ) &&
+         l_name.compare( l_name.size() - strlen( CORPUS_REPLAY_EXT ),
+                         std::string::npos, CORPUS_REPLAY_EXT ) == 0 )
+    {
+      l_replays.push_back( l_name );
+    }
+  }
+  closedir( l_dir );
+  std::sort( l_replays.begin(), l_replays.end() );
+
+  /* Replay each one, and check it against its baseline. */
+  get_clock()->set_mode( CLOCK_UNTHROTTLED );
+  heap_set_strict( true );
+  for ( const std::string &l_replay : l_replays )
+  {
+    std::string l_path = std::string( l_dir_name ) + "/" + l_replay;
+    l_hash_name = l_path.substr( 0, l_path.size() - strlen( CORPUS_REPLAY_EXT ) );
+    l_golden_name = l_hash_name + CORPUS_GOLDEN_EXT;
+    l_hash_name += CORPUS_HASH_EXT;
+
+    /* Goldens are optional; it's the frame list we need, to replay. */
+    if ( !load_goldens( l_golden_name.c_str(), l_expected ) )
+    {
+      l_expected.clear();
+    }
+    l_goldens = l_expected;
+
+    if ( !replay_hashes( l_path.c_str(), l_current, l_goldens ) )
+    {
+      printf( "%-24s unreadable recording\n", l_replay.c_str() );
+      l_pass = false;
+      continue;
+    }
+
+    /* Updating, we just save what we've got. */
+    if ( l_update )
+    {
+      if ( !l_current.save( l_hash_name.c_str() ) )
+      {
+        fprintf( stderr, "Unable to write %s\n", l_hash_name.c_str() );
+        return 1;
+      }
+      printf( "%-24s baseline written (%u frames)\n", l_replay.c_str(), l_current.get_length() );
+      if ( !l_goldens.empty() && !save_goldens( l_golden_name.c_str(), l_goldens ) )
+      {
+        fprintf( stderr, "Unable to write %s\n", l_golden_name.c_str() );
+        return 1;
+      }
+      continue;
+    }
+
+    /* Otherwise, a recording without a baseline can't be checked; that's a */
+    /* failure, or one committed without its baseline would always pass.   */
+    if ( !l_baseline.load( l_hash_name.c_str() ) )
+    {
+      printf( "%-24s NO BASELINE: %s is missing or unreadable; run with --update\n", l_replay.c_str(),
+              l_hash_name.c_str() );
+      l_pass = false;
+      continue;
+    }
+
+    l_pass = compare( l_replay.c_str(), l_baseline, l_current ) && l_pass;
+    if ( !l_expected.empty() )
+    {
+      l_pass = compare_goldens( l_replay.c_str(), l_expected, l_goldens ) && l_pass;
+    }
+  }
+
+  /* All done. */
+  return l_pass ? 0 : 1;
+}
+
+
+/* End of file host/corpus.cpp */
@@ -0,0 +1,241 @@
+/*
+ * host/drift.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                 for the PicoSystem.
+ *
+ * This is the entry point for the timer drift check; it runs TickScheduler
+ * through hours of simulated time, in jittery frame sized steps, and checks
+ * that every timer has fired exactly as often as it should have.
+ *
+ * Timers with steady periods (fractional ones included) must match the exact
+ * count; timers retimed every frame with the same period must match them too.
+ * A timer whose period sweeps like the invader tempo is checked against its
+ * ideal phase, worked out in floating point, and must stay within a thousandth
+ * of a firing of it.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/scheduler.hpp"
+
+
+/* Constants. */
+
+#define DRIFT_NOMINAL_US    25000
+#define DRIFT_TIMERS        3
+#define DRIFT_TOLERANCE     0.001           /* Of a firing. */
+
+
+/* Structures. */
+
+struct drift_period_t
+{
+  const char   *name;
+  uint32_t      period_us;
+  uint32_t      divisor;
+};
+
+
+/* Module variables. */
+
+static uint32_t m_seed = 1;
+
+/* A mix of the game's own periods and fractional ones. */
+static const drift_period_t m_periods[DRIFT_TIMERS] = {
+  { "17ms",     17000,   1    },
+  { "60Hz",     1000000, 60   },
+  { "333.3us",  1000000, 3000 }
+};
+
+
+/* Functions. */
+
+/*
+ * random_next - a small xorshift generator, so that a seed always gives the
+ *               same run.
+ */
+
+static uint32_t random_next( void )
+{
+  m_seed ^= m_seed << 13;
+  m_seed ^= m_seed >> 17;
+  m_seed ^= m_seed << 5;
+  return m_seed;
+}
+
+
+/*
+ * random_delta - a frame's delta in microseconds; mostly around the nominal
+ *                frame, with the occasional long stall.
+ */
+
+static uint32_t random_delta( void )
+{
+  if ( random_next() % 64 == 0 )
+  {
+    return DRIFT_NOMINAL_US + random_next() % 250000;
+  }
+  return DRIFT_NOMINAL_US - 5000 + random_next() % 10001;
+}
+
+
+/*
+ * tempo_us - the period of the swept timer at a given frame; the invader
+ *            tempo from a full sheet down to the last one, over and over,
+ *            with a fraction of a millisecond thrown in.
+ */
+
+static uint32_t tempo_us( uint32_t p_frame )
+{
+  uint32_t l_invaders = 50 - ( p_frame / 40 ) % 50;
+  return 10000 + l_invaders * 7000 + ( p_frame % 7 ) * 137;
+}
+
+
+/*
+ * usage - explains how to use the checker.
+ */
+
+static void usage( const char *p_name )
+{
+  fprintf( stderr, "Usage: %s [options]\n", p_name );
+  fprintf( stderr, "  --hours N        hours of simulated time to run (default 4)\n" );
+  fprintf( stderr, "  --seed N         random seed for the frame deltas (default 1)\n" );
+}
+
+
+/*
+ * main - runs the timers for as long as asked, and reports how they did.
+ */
+
+int main( int argc, char **argv )
+{
+  TickScheduler l_steady, l_retimed, l_swept;
+  uint64_t      l_end_us, l_time_us;
+  uint64_t      l_expected[DRIFT_TIMERS];
+  uint64_t      l_steady_count[DRIFT_TIMERS] = { 0 }, l_retimed_count[DRIFT_TIMERS] = { 0 };
+  uint64_t      l_swept_count = 0, l_frames = 0, l_mismatches = 0;
+  uint32_t      l_hours = 4, l_delta_us, l_period_us;
+  uint_fast8_t  l_timer;
+  double        l_phase = 0.0, l_error, l_worst_error = -1.0;
+  bool          l_failed = false;
+
+  /* Work through the arguments. */
+  for ( int l_arg = 1; l_arg < argc; l_arg++ )
+  {
+    if ( strcmp( argv[l_arg], "--hours" ) == 0 && l_arg + 1 < argc )
+    {
+      l_hours = std::max( 1UL, strtoul( argv[++l_arg], nullptr, 10 ) );
+    }
+    else if ( strcmp( argv[l_arg], "--seed" ) == 0 && l_arg + 1 < argc )
+    {
+      m_seed = std::max( 1UL, strtoul( argv[++l_arg], nullptr, 10 ) );
+    }
+    else
+    {
+      usage( argv[0] );
+      return 1;
+    }
+  }
+
+  /* The same periods twice over; one left alone, one retimed every frame. */
+  for ( const drift_period_t &l_period : m_periods )
+  {
+    l_steady.add( l_period.period_us, l_period.divisor );
+    l_retimed.add( l_period.period_us, l_period.divisor );
+  }
+  l_swept.add( tempo_us( 0 ) );
+
+  /* Run frame after frame, until the time is up. */
+  l_end_us = (uint64_t)l_hours * 3600 * 1000000;
+  while ( l_steady.get_time() < l_end_us )
+  {
+    l_delta_us = random_delta();
+
+    /* Retiming with the same period mustn't move anything. */
+    for ( l_timer = 0; l_timer < DRIFT_TIMERS; l_timer++ )
+    {
+      l_retimed.set_period( l_timer, m_periods[l_timer].period_us, m_periods[l_timer].divisor );
+    }
+
+    /* The swept timer takes this frame's tempo, and keeps its phase. */
+    l_period_us = tempo_us( l_frames );
+    l_swept.set_period( 0, l_period_us );
+    l_phase += (double)l_delta_us / l_period_us;
+
+    /* Advance them all, and count everything that fires. */
+    l_steady.advance( l_delta_us );
+    l_retimed.advance( l_delta_us );
+    l_swept.advance( l_delta_us );
+    l_steady.reset_counts();
+    l_retimed.reset_counts();
+    l_swept.reset_counts();
+    while ( ( l_timer = l_steady.next() ) != SCHEDULER_NONE )
+    {
+      l_steady_count[l_timer]++;
+    }
+    while ( ( l_timer = l_retimed.next() ) != SCHEDULER_NONE )
+    {
+      l_retimed_count[l_timer]++;
+    }
+    while ( l_swept.next() != SCHEDULER_NONE )
+    {
+      l_swept_count++;
+    }
+    l_frames++;
+
+    /* The steady timers should be exact, every frame. */
+    l_time_us = l_steady.get_time();
+    for ( l_timer = 0; l_timer < DRIFT_TIMERS; l_timer++ )
+    {
+      l_expected[l_timer] = l_time_us * m_periods[l_timer].divisor / m_periods[l_timer].period_us;
+      if ( l_steady_count[l_timer] != l_expected[l_timer] ||
+           l_retimed_count[l_timer] != l_expected[l_timer] )
+      {
+        l_mismatches++;
+      }
+    }
+
+    /* And the swept one should have fired once for every whole period of */
+    /* phase; how far outside that it strays is the error.                 */
+    l_error = std::max( (double)l_swept_count - l_phase, l_phase - l_swept_count - 1.0 );
+    l_worst_error = std::max( l_worst_error, l_error );
+  }
+
+  /* Report on how each one did. */
+  printf( "%llu frames, %.2f hours simulated\n\n", (unsigned long long)l_frames,
+          l_steady.get_time() / 3600e6 );
+  printf( "%-10s %14s %14s %14s\n", "timer", "expected", "steady", "retimed" );
+  for ( l_timer = 0; l_timer < DRIFT_TIMERS; l_timer++ )
+  {
+    printf( "%-10s %14llu %14llu %14llu\n", m_periods[l_timer].name,
+            (unsigned long long)l_expected[l_timer], (unsigned long long)l_steady_count[l_timer],
+            (unsigned long long)l_retimed_count[l_timer] );
+  }
+  printf( "%-10s %14.0f %14llu %14s\n", "tempo", floor( l_phase ),
+          (unsigned long long)l_swept_count, "-" );
+  printf( "\nsteady and retimed mismatches: %llu frames\n", (unsigned long long)l_mismatches );
+  printf( "worst tempo phase error: %.6f firings\n", std::max( l_worst_error, 0.0 ) );
+
+  if ( l_mismatches > 0 || l_worst_error > DRIFT_TOLERANCE )
+  {
+    printf( "FAILED\n" );
+    l_failed = true;
+  }
+
+  /* All done. */
+  return l_failed ? 1 : 0;
+}
+
+
+/* End of file host/drift.cpp */
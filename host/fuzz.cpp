@@ -0,0 +1,469 @@
+/*
+ * host/fuzz.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                for the PicoSystem.
+ *
+ * This is the entry point for the worst-case frame finder; rather than timing
+ * typical play, it searches for the inputs and frame deltas that make single
+ * frames as slow as possible (or make the tickers catch up the most).
+ *
+ * A population of random candidates is played through the headless game from
+ * launch, each scored by its worst frame; the worst few are kept, mutated and
+ * played again, round after round. The very worst are saved as recordings,
+ * which picovaders_host --replay (or the corpus) can reproduce exactly.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+
+/* Local headers. */
+
+#include "harness.hpp"
+#include "utils/clock.hpp"
+#include "utils/flight.hpp"
+#include "utils/replay.hpp"
+
+
+/* Constants. */
+
+/* Every candidate sits through the splash, and starts the game from the title. */
+#define FUZZ_SPLASH_FRAMES  84
+#define FUZZ_START_FRAMES   2
+#define FUZZ_PREFIX_FRAMES  ( FUZZ_SPLASH_FRAMES + FUZZ_START_FRAMES + 4 )
+
+#define FUZZ_NOMINAL_DELTA  25
+#define FUZZ_CAPACITY       ( 64 * 1024 )
+
+typedef enum
+{
+  METRIC_TIME,                      /* Slowest update + draw, in microseconds. */
+  METRIC_TICKS,                     /* Most ticker iterations in one update.  */
+  METRIC_PIXELS                     /* Most pixels drawn in one frame.        */
+} fuzzmetric_t;
+
+
+/* Structures. */
+
+struct fuzz_frame_t
+{
+  uint8_t       buttons;
+  uint16_t      delta_ms;
+};
+
+struct candidate_t
+{
+  std::vector<fuzz_frame_t> frames;
+  uint32_t      score;
+  uint32_t      worst_frame;
+  gamestate_t   worst_state;
+  uint32_t      worst_update_us;
+  uint32_t      worst_draw_us;
+  uint32_t      worst_ticks;
+  uint32_t      worst_pixels;
+};
+
+
+/* Module variables. */
+
+static uint32_t     m_seed = 1;
+static uint32_t     m_max_delta_ms = 250;
+static fuzzmetric_t m_metric = METRIC_TIME;
+static uint32_t     m_repeats = 3;
+
+/* The buttons that matter, once the game is running. */
+static const uint8_t m_button_choices[] = {
+  0, REPLAY_LEFT, REPLAY_RIGHT, REPLAY_A, REPLAY_LEFT | REPLAY_A, REPLAY_RIGHT | REPLAY_A
+};
+
+
+/* Functions. */
+
+/*
+ * random_next - a small xorshift generator, so that a seed always gives the
+ *               same search.
+ */
+
+static uint32_t random_next( void )
+{
+  m_seed ^= m_seed << 13;
+  m_seed ^= m_seed >> 17;
+  m_seed ^= m_seed << 5;
+  return m_seed;
+}
+
+
+/*
+ * random_range - returns a number from p_min to p_max, inclusive.
+ */
+
+static uint32_t random_range( uint32_t p_min, uint32_t p_max )
+{
+  return p_min + random_next() % ( p_max - p_min + 1 );
+}
+
+
+/*
+ * random_delta - mostly a steady frame, with the occasional long one.
+ */
+
+static uint16_t random_delta( void )
+{
+  if ( random_range( 0, 15 ) == 0 )
+  {
+    return random_range( FUZZ_NOMINAL_DELTA, m_max_delta_ms );
+  }
+  return random_range( FUZZ_NOMINAL_DELTA - 5, FUZZ_NOMINAL_DELTA + 5 );
+}
+
+
+/*
+ * randomise - fills a candidate with random runs of buttons and deltas, after
+ *             the fixed prefix which gets it into the game.
+ */
+
+static void randomise( candidate_t &p_candidate, uint32_t p_frames )
+{
+  uint8_t   l_buttons = 0;
+  uint32_t  l_frame, l_run = 0;
+
+  p_candidate.frames.resize( p_frames );
+  for ( l_frame = 0; l_frame < p_frames; l_frame++ )
+  {
+    if ( l_frame < FUZZ_PREFIX_FRAMES )
+    {
+      p_candidate.frames[l_frame].buttons =
+        ( l_frame >= FUZZ_SPLASH_FRAMES && l_frame < FUZZ_SPLASH_FRAMES + FUZZ_START_FRAMES ) ? REPLAY_X : 0;
+      p_candidate.frames[l_frame].delta_ms = FUZZ_NOMINAL_DELTA;
+      continue;
+    }
+
+    /* Players hold buttons for a while, so pick them in runs. */
+    if ( l_run == 0 )
+    {
+      l_buttons = m_button_choices[random_range( 0, sizeof( m_button_choices ) - 1 )];
+      l_run = random_range( 1, 40 );
+    }
+    l_run--;
+    p_candidate.frames[l_frame].buttons = l_buttons;
+    p_candidate.frames[l_frame].delta_ms = random_delta();
+  }
+}
+
+
+/*
+ * mutate - makes a small random change to a candidate; the prefix is left
+ *          alone, so it still reaches the game.
+ */
+
+static void mutate( candidate_t &p_candidate, const candidate_t &p_other )
+{
+  uint32_t  l_length = p_candidate.frames.size();
+  uint32_t  l_start = random_range( FUZZ_PREFIX_FRAMES, l_length - 1 );
+  uint32_t  l_end = std::min( l_length, l_start + random_range( 1, 60 ) );
+  uint8_t   l_buttons;
+
+  switch( random_range( 0, 4 ) )
+  {
+    case 0:                          /* Hold a different set of buttons. */
+      l_buttons = m_button_choices[random_range( 0, sizeof( m_button_choices ) - 1 )];
+      for ( uint32_t l_frame = l_start; l_frame < l_end; l_frame++ )
+      {
+        p_candidate.frames[l_frame].buttons = l_buttons;
+      }
+      break;
+    case 1:                          /* Stall a single frame. */
+      p_candidate.frames[l_start].delta_ms = random_range( FUZZ_NOMINAL_DELTA, m_max_delta_ms );
+      break;
+    case 2:                          /* Smooth out a stretch of frames. */
+      for ( uint32_t l_frame = l_start; l_frame < l_end; l_frame++ )
+      {
+        p_candidate.frames[l_frame].delta_ms = FUZZ_NOMINAL_DELTA;
+      }
+      break;
+    case 3:                          /* Jitter a stretch of frames. */
+      for ( uint32_t l_frame = l_start; l_frame < l_end; l_frame++ )
+      {
+        p_candidate.frames[l_frame].delta_ms = random_delta();
+      }
+      break;
+    default:                         /* Take the rest from another candidate. */
+      std::copy( p_other.frames.begin() + l_start, p_other.frames.end(),
+                 p_candidate.frames.begin() + l_start );
+      break;
+  }
+}
+
+
+/*
+ * encode - turns a candidate into a recording, which is both how it gets
+ *          played and how it gets saved.
+ */
+
+static uint32_t encode( const candidate_t &p_candidate, std::vector<uint8_t> &p_buffer )
+{
+  p_buffer.resize( FUZZ_CAPACITY );
+  InputRecorder l_recorder( p_buffer.data(), p_buffer.size() );
+
+  for ( const fuzz_frame_t &l_frame : p_candidate.frames )
+  {
+    l_recorder.record( l_frame.buttons, l_frame.delta_ms );
+  }
+  return l_recorder.finish();
+}
+
+
+/*
+ * evaluate - plays a candidate through from launch, and scores it by its
+ *            worst frame. Timings are noisy, so they're taken as the best of
+ *            a few runs; ticker and pixel counts are exact, so are only run
+ *            once.
+ */
+
+static void evaluate( candidate_t &p_candidate )
+{
+  std::vector<uint8_t>  l_buffer;
+  HostHarness           l_harness;
+  frame_timing_t        l_timing;
+  flight_frame_t        l_flight;
+  candidate_t           l_worst{};
+  uint32_t              l_length, l_repeat, l_ticks, l_score;
+
+  l_length = encode( p_candidate, l_buffer );
+  p_candidate.score = UINT32_MAX;
+
+  for ( l_repeat = 0; l_repeat < ( m_metric == METRIC_TIME ? m_repeats : 1 ); l_repeat++ )
+  {
+    InputPlayer l_player( l_buffer.data(), l_length );
+    l_harness.set_paced( false );
+    l_harness.start();
+    set_input_player( &l_player );
+
+    /* Start every run from nothing; a run that never scores above zero */
+    /* still reports a (zero) worst frame, and no state.                 */
+    l_worst = candidate_t{};
+    l_worst.worst_state = GAMESTATE_MAX;
+    for ( uint32_t l_frame = 0; l_frame < p_candidate.frames.size(); l_frame++ )
+    {
+      l_timing = l_harness.step();
+      flight_get_frames( &l_flight, 1 );
+      l_ticks = 0;
+      for ( uint8_t l_count : l_flight.ticks )
+      {
+        l_ticks += l_count;
+      }
+
+      /* Is this the worst frame of the run? The prefix is the same for  */
+      /* every candidate, so there's nothing to find in it.              */
+      if ( l_frame < FUZZ_PREFIX_FRAMES )
+      {
+        continue;
+      }
+      switch( m_metric )
+      {
+        case METRIC_TIME:
+          l_score = l_timing.update_us + l_timing.draw_us;
+          break;
+        case METRIC_TICKS:
+          l_score = l_ticks;
+          break;
+        default:
+          l_score = l_timing.render.pixels;
+          break;
+      }
+      if ( l_score > l_worst.score )
+      {
+        l_worst.score = l_score;
+        l_worst.worst_frame = l_frame;
+        l_worst.worst_state = l_timing.state;
+        l_worst.worst_update_us = l_timing.update_us;
+        l_worst.worst_draw_us = l_timing.draw_us;
+        l_worst.worst_ticks = l_ticks;
+        l_worst.worst_pixels = l_timing.render.pixels;
+      }
+    }
+    set_input_player( nullptr );
+
+    /* Keep the details of whichever run was the least bad. */
+    if ( l_worst.score < p_candidate.score )
+    {
+      p_candidate.score = l_worst.score;
+      p_candidate.worst_frame = l_worst.worst_frame;
+      p_candidate.worst_state = l_worst.worst_state;
+      p_candidate.worst_update_us = l_worst.worst_update_us;
+      p_candidate.worst_draw_us = l_worst.worst_draw_us;
+      p_candidate.worst_ticks = l_worst.worst_ticks;
+      p_candidate.worst_pixels = l_worst.worst_pixels;
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * usage - explains how to use the finder.
+ */
+
+static void usage( const char *p_name )
+{
+  fprintf( stderr, "Usage: %s [options]\n", p_name );
+  fprintf( stderr, "  --metric M       time (slowest frame, default) or ticks (most ticker\n" );
+  fprintf( stderr, "                   catch-up iterations in one frame) or pixels (most\n" );
+  fprintf( stderr, "                   pixels drawn in one frame)\n" );
+  fprintf( stderr, "  --seed N         random seed (default 1)\n" );
+  fprintf( stderr, "  --rounds N       rounds of mutation (default 20)\n" );
+  fprintf( stderr, "  --population N   candidates per round (default 12)\n" );
+  fprintf( stderr, "  --frames N       frames per candidate, from launch (default 400)\n" );
+  fprintf( stderr, "  --max-delta MS   longest frame delta to try (default 250)\n" );
+  fprintf( stderr, "  --repeats N      runs per candidate when timing (default 3)\n" );
+  fprintf( stderr, "  --keep N         how many of the worst to save (default 3)\n" );
+  fprintf( stderr, "  --out PREFIX     save them as PREFIX_1.pvr ... (default worst)\n" );
+}
+
+
+/*
+ * main - runs the search, and saves the worst cases found.
+ */
+
+int main( int argc, char **argv )
+{
+  std::vector<candidate_t>  l_population;
+  std::vector<uint8_t>      l_buffer;
+  uint32_t                  l_rounds = 20, l_size = 12, l_frames = 400, l_keep = 3;
+  uint32_t                  l_elites, l_length;
+  const char               *l_prefix = "worst";
+  char                      l_filename[256];
+
+  /* Work through the arguments. */
+  for ( int l_arg = 1; l_arg < argc; l_arg++ )
+  {
+    if ( strcmp( argv[l_arg], "--metric" ) == 0 && l_arg + 1 < argc )
+    {
+      l_arg++;
+      if ( strcmp( argv[l_arg], "time" ) == 0 )
+      {
+        m_metric = METRIC_TIME;
+      }
+      else if ( strcmp( argv[l_arg], "ticks" ) == 0 )
+      {
+        m_metric = METRIC_TICKS;
+      }
+      else if ( strcmp( argv[l_arg], "pixels" ) == 0 )
+      {
+        m_metric = METRIC_PIXELS;
+      }
+      else
+      {
+        fprintf( stderr, "Unknown metric %s\n", argv[l_arg] );
+        return 1;
+      }
+    }
+    else if ( strcmp( argv[l_arg], "--seed" ) == 0 && l_arg + 1 < argc )
+    {
+      m_seed = std::max( 1UL, strtoul( argv[++l_arg], nullptr, 10 ) );
+    }
+    else if ( strcmp( argv[l_arg], "--rounds" ) == 0 && l_arg + 1 < argc )
+    {
+      l_rounds = strtoul( argv[++l_arg], nullptr, 10 );
+    }
+    else if ( strcmp( argv[l_arg], "--population" ) == 0 && l_arg + 1 < argc )
+    {
+      l_size = std::max( 2UL, strtoul( argv[++l_arg], nullptr, 10 ) );
+    }
+    else if ( strcmp( argv[l_arg], "--frames" ) == 0 && l_arg + 1 < argc )
+    {
+      l_frames = std::max( (unsigned long)FUZZ_PREFIX_FRAMES + 1, strtoul( argv[++l_arg], nullptr, 10 ) );
+    }
+    else if ( strcmp( argv[l_arg], "--max-delta" ) == 0 && l_arg + 1 < argc )
+    {
+      m_max_delta_ms = std::max( (unsigned long)FUZZ_NOMINAL_DELTA, strtoul( argv[++l_arg], nullptr, 10 ) );
+    }
+    else if ( strcmp( argv[l_arg], "--repeats" ) == 0 && l_arg + 1 < argc )
+    {
+      m_repeats = std::max( 1UL, strtoul( argv[++l_arg], nullptr, 10 ) );
+    }
+    else if ( strcmp( argv[l_arg], "--keep" ) == 0 && l_arg + 1 < argc )
+    {
+      l_keep = strtoul( argv[++l_arg], nullptr, 10 );
+    }
+    else if ( strcmp( argv[l_arg], "--out" ) == 0 && l_arg + 1 < argc )
+    {
+      l_prefix = argv[++l_arg];
+    }
+    else
+    {
+      usage( argv[0] );
+      return 1;
+    }
+  }
+
+  /* The recordings provide the deltas, so the clock itself mustn't wait. */
+  get_clock()->set_mode( CLOCK_UNTHROTTLED );
+
+  /* Start from a random population. */
+  l_population.resize( l_size );
+  for ( candidate_t &l_candidate : l_population )
+  {
+    randomise( l_candidate, l_frames );
+    evaluate( l_candidate );
+  }
+
+  /* Each round, the worst quarter survive and the rest are their mutants. */
+  l_elites = std::max( 1U, l_size / 4 );
+  for ( uint32_t l_round = 0; l_round <= l_rounds; l_round++ )
+  {
+    std::sort( l_population.begin(), l_population.end(),
+               []( const candidate_t &a, const candidate_t &b ) { return a.score > b.score; } );
+    printf( "round %3u: worst %6u%s (frame %u, %s)\n", l_round, l_population[0].score,
+            m_metric == METRIC_TIME ? "us" : m_metric == METRIC_TICKS ? " ticks" : " pixels",
+            l_population[0].worst_frame,
+            gamestate_name( l_population[0].worst_state ) );
+    fflush( stdout );
+    if ( l_round == l_rounds )
+    {
+      break;
+    }
+
+    for ( uint32_t l_index = l_elites; l_index < l_size; l_index++ )
+    {
+      l_population[l_index] = l_population[random_range( 0, l_elites - 1 )];
+      for ( uint32_t l_count = random_range( 1, 3 ); l_count > 0; l_count-- )
+      {
+        mutate( l_population[l_index], l_population[random_range( 0, l_elites - 1 )] );
+      }
+      evaluate( l_population[l_index] );
+    }
+  }
+
+  /* Save the worst of them, so they can be replayed. */
+  printf( "\n%-20s %8s %8s %8s %8s %8s %8s\n", "recording", "frame", "state", "update", "draw",
+          "ticks", "pixels" );
+  for ( uint32_t l_index = 0; l_index < std::min( l_keep, l_size ); l_index++ )
+  {
+    const candidate_t &l_candidate = l_population[l_index];
+
+    snprintf( l_filename, sizeof( l_filename ), "%s_%u.pvr", l_prefix, l_index + 1 );
+    l_length = encode( l_candidate, l_buffer );
+    if ( !host_save_file( l_filename, l_buffer.data(), l_length ) )
+    {
+      fprintf( stderr, "Unable to write %s\n", l_filename );
+      return 1;
+    }
+    printf( "%-20s %8u %8s %6uus %6uus %8u %8u\n", l_filename, l_candidate.worst_frame,
+            gamestate_name( l_candidate.worst_state ), l_candidate.worst_update_us,
+            l_candidate.worst_draw_us, l_candidate.worst_ticks, l_candidate.worst_pixels );
+  }
+
+  /* All done. */
+  return 0;
+}
+
+
+/* End of file host/fuzz.cpp */
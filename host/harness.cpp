@@ -0,0 +1,490 @@
+/*
+ * host/harness.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file implements the host harness; it stands in for the SDK's main loop,
+ * driving the game's init/update/draw functions one frame at a time with
+ * scripted input, and timing each phase as it goes.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "harness.hpp"
+#include "utils/clock.hpp"
+
+
+/* Module variables. */
+
+static const struct
+{
+  const char   *name;
+  uint32_t      mask;
+} m_button_names[] = {
+  { "UP",    HOST_BUTTON(UP) },    { "DOWN",  HOST_BUTTON(DOWN) },
+  { "LEFT",  HOST_BUTTON(LEFT) },  { "RIGHT", HOST_BUTTON(RIGHT) },
+  { "A",     HOST_BUTTON(A) },     { "B",     HOST_BUTTON(B) },
+  { "X",     HOST_BUTTON(X) },     { "Y",     HOST_BUTTON(Y) },
+};
+
+
+/* Functions. */
+
+/*
+ * host_load_file - reads a whole binary file into the vector provided;
+ *                  returns false if it can't be read.
+ */
+
+bool host_load_file( const char *p_filename, std::vector<uint8_t> &p_data )
+{
+  FILE     *l_file;
+  uint8_t   l_buffer[4096];
+  size_t    l_read;
+
+  l_file = fopen( p_filename, "rb" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+  p_data.clear();
+  while ( ( l_read = fread( l_buffer, 1, sizeof( l_buffer ), l_file ) ) > 0 )
+  {
+    p_data.insert( p_data.end(), l_buffer, l_buffer + l_read );
+  }
+  fclose( l_file );
+  return true;
+}
+
+
+/*
+ * host_save_file - writes a block of data out to a file; returns false if
+ *                  it can't be written.
+ */
+
+bool host_save_file( const char *p_filename, const uint8_t *p_data, uint32_t p_length )
+{
+  FILE     *l_file;
+  bool      l_result;
+
+  l_file = fopen( p_filename, "wb" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+  l_result = fwrite( p_data, 1, p_length, l_file ) == p_length;
+  return ( fclose( l_file ) == 0 ) && l_result;
+}
+
+
+/*
+ * host_framebuffer_hash - hashes the whole screen, with FNV-1a.
+ */
+
+uint32_t host_framebuffer_hash( void )
+{
+  const picosystem::buffer_t *l_screen = picosystem::SCREEN;
+  uint32_t                    l_hash = 2166136261U;
+
+  for ( int32_t l_index = 0; l_index < l_screen->w * l_screen->h; l_index++ )
+  {
+    l_hash = ( l_hash ^ ( l_screen->data[l_index] & 0xff ) ) * 16777619U;
+    l_hash = ( l_hash ^ ( l_screen->data[l_index] >> 8 ) ) * 16777619U;
+  }
+  return l_hash;
+}
+
+
+/*
+ * host_save_ppm - writes the screen out as a binary PPM image; returns false
+ *                 if it can't be written.
+ */
+
+bool host_save_ppm( const char *p_filename )
+{
+  const picosystem::buffer_t *l_screen = picosystem::SCREEN;
+  std::vector<uint8_t>        l_pixels;
+  char                        l_header[32];
+  int                         l_header_len;
+
+  /* Expand each 4 bit channel up to 8 bits; alpha is dropped. */
+  l_header_len = snprintf( l_header, sizeof( l_header ), "P6\n%d %d\n255\n",
+                           l_screen->w, l_screen->h );
+  l_pixels.assign( l_header, l_header + l_header_len );
+  for ( int32_t l_index = 0; l_index < l_screen->w * l_screen->h; l_index++ )
+  {
+    picosystem::color_t l_colour = l_screen->data[l_index];
+    l_pixels.push_back( ( l_colour & 0xf ) * 17 );
+    l_pixels.push_back( ( ( l_colour >> 12 ) & 0xf ) * 17 );
+    l_pixels.push_back( ( ( l_colour >> 8 ) & 0xf ) * 17 );
+  }
+
+  return host_save_file( p_filename, l_pixels.data(), l_pixels.size() );
+}
+
+
+/*
+ * host_save_heatmap - writes an overdraw heatmap out as a PPM image; each pixel
+ *                     is coloured by the average number of times it was written
+ *                     per frame, from black (never) through blue (once), green
+ *                     (twice), yellow (three times) to red (four or more).
+ */
+
+bool host_save_heatmap( const char *p_filename, const uint32_t *p_heatmap, uint32_t p_frames )
+{
+  static const uint8_t        l_ramp[][3] = {
+    { 0, 0, 0 }, { 0, 64, 255 }, { 0, 224, 64 }, { 255, 224, 0 }, { 255, 0, 0 }
+  };
+  const picosystem::buffer_t *l_screen = picosystem::SCREEN;
+  std::vector<uint8_t>        l_pixels;
+  char                        l_header[32];
+  int                         l_header_len;
+  uint32_t                    l_level;
+
+  if ( p_frames == 0 )
+  {
+    p_frames = 1;
+  }
+
+  /* Round each average to the nearest whole write, and look up its colour. */
+  l_header_len = snprintf( l_header, sizeof( l_header ), "P6\n%d %d\n255\n",
+                           l_screen->w, l_screen->h );
+  l_pixels.assign( l_header, l_header + l_header_len );
+  for ( int32_t l_index = 0; l_index < l_screen->w * l_screen->h; l_index++ )
+  {
+    l_level = ( p_heatmap[l_index] + p_frames / 2 ) / p_frames;
+    if ( l_level > 4 )
+    {
+      l_level = 4;
+    }
+    l_pixels.insert( l_pixels.end(), l_ramp[l_level], l_ramp[l_level] + 3 );
+  }
+
+  return host_save_file( p_filename, l_pixels.data(), l_pixels.size() );
+}
+
+
+/*
+ * host_parse_buttons - turns a list of button names ("LEFT A", "LEFT+A") into
+ *                      a button mask; "-" or an empty string is no buttons.
+ */
+
+uint32_t host_parse_buttons( const char *p_names )
+{
+  char      l_name[16];
+  uint32_t  l_mask = 0;
+  size_t    l_len;
+
+  while ( *p_names != '\0' )
+  {
+    /* Skip separators. */
+    l_len = strcspn( p_names, " \t+,\r\n" );
+    if ( l_len == 0 )
+    {
+      p_names++;
+      continue;
+    }
+
+    /* Copy the name out, and look it up. */
+    if ( l_len < sizeof( l_name ) )
+    {
+      memcpy( l_name, p_names, l_len );
+      l_name[l_len] = '\0';
+      for ( const auto &l_button : m_button_names )
+      {
+        if ( strcasecmp( l_name, l_button.name ) == 0 )
+        {
+          l_mask |= l_button.mask;
+        }
+      }
+    }
+    p_names += l_len;
+  }
+
+  /* All done. */
+  return l_mask;
+}
+
+
+/*
+ * host_parse_clock - sets the game clock from a mode name; "realtime", or
+ *                    "fixed" or "unthrottled" with an optional ":<step ms>".
+ *                    Returns false if the mode isn't recognised.
+ */
+
+bool host_parse_clock( const char *p_mode )
+{
+  const char   *l_step = strchr( p_mode, ':' );
+  uint32_t      l_step_ms = CLOCK_DEFAULT_STEP_MS;
+  size_t        l_len = l_step ? (size_t)( l_step - p_mode ) : strlen( p_mode );
+
+  if ( l_step != nullptr )
+  {
+    l_step_ms = strtoul( l_step + 1, nullptr, 10 );
+    if ( l_step_ms == 0 )
+    {
+      return false;
+    }
+  }
+
+  if ( strncmp( p_mode, "realtime", l_len ) == 0 && l_len == 8 )
+  {
+    get_clock()->set_mode( CLOCK_REALTIME );
+  }
+  else if ( strncmp( p_mode, "fixed", l_len ) == 0 && l_len == 5 )
+  {
+    get_clock()->set_mode( CLOCK_FIXED, l_step_ms );
+  }
+  else if ( strncmp( p_mode, "unthrottled", l_len ) == 0 && l_len == 11 )
+  {
+    get_clock()->set_mode( CLOCK_UNTHROTTLED, l_step_ms );
+  }
+  else
+  {
+    return false;
+  }
+
+  /* All done. */
+  return true;
+}
+
+
+/*
+ * InputScript::load - reads a script from a file; returns false if it can't
+ *                     be read or parsed.
+ */
+
+bool InputScript::load( const char *p_filename )
+{
+  FILE         *l_file;
+  std::string   l_text;
+  char          l_buffer[256];
+
+  /* Slurp the whole file in, and hand it on to the parser. */
+  l_file = fopen( p_filename, "r" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+  while ( fgets( l_buffer, sizeof( l_buffer ), l_file ) != nullptr )
+  {
+    l_text += l_buffer;
+  }
+  fclose( l_file );
+
+  return this->parse( l_text.c_str() );
+}
+
+
+/*
+ * InputScript::parse - parses script text; one run per line, as a frame count
+ *                      followed by the buttons held. Semicolons can also be
+ *                      used to separate runs, and '#' starts a comment.
+ */
+
+bool InputScript::parse( const char *p_text )
+{
+  std::string   l_text, l_line;
+  char         *l_end;
+  unsigned long l_frames;
+  size_t        l_start, l_len;
+
+  /* Strip out comments first, and treat semicolons like new lines. */
+  for ( ; *p_text != '\0'; p_text++ )
+  {
+    if ( *p_text == '#' )
+    {
+      while ( p_text[1] != '\0' && p_text[1] != '\n' )
+      {
+        p_text++;
+      }
+      continue;
+    }
+    l_text += ( *p_text == ';' ) ? '\n' : *p_text;
+  }
+
+  for ( l_start = 0; l_start < l_text.size(); l_start += l_len + 1 )
+  {
+    /* Pull out the next line, skipping blank ones. */
+    l_len = l_text.find( '\n', l_start );
+    l_len = ( l_len == std::string::npos ? l_text.size() : l_len ) - l_start;
+    l_line = l_text.substr( l_start, l_len );
+    if ( l_line.find_first_not_of( " \t\r" ) == std::string::npos )
+    {
+      continue;
+    }
+
+    /* Lines start with a frame count. */
+    l_frames = strtoul( l_line.c_str(), &l_end, 10 );
+    if ( l_end == l_line.c_str() )
+    {
+      return false;
+    }
+    this->add( l_frames, host_parse_buttons( l_end ) );
+  }
+
+  /* All done. */
+  return true;
+}
+
+
+/*
+ * InputScript::add - appends a run of held buttons to the script.
+ */
+
+void InputScript::add( uint32_t p_frames, uint32_t p_buttons )
+{
+  /* Merge with the previous run if it's the same buttons. */
+  if ( !this->m_runs.empty() && this->m_runs.back().buttons == p_buttons )
+  {
+    this->m_runs.back().frames += p_frames;
+    return;
+  }
+  this->m_runs.push_back( { p_frames, p_buttons } );
+}
+
+
+/*
+ * InputScript::get_buttons - returns the buttons held in the given frame.
+ */
+
+uint32_t InputScript::get_buttons( uint32_t p_frame )
+{
+  for ( const auto &l_run : this->m_runs )
+  {
+    if ( p_frame < l_run.frames )
+    {
+      return l_run.buttons;
+    }
+    p_frame -= l_run.frames;
+  }
+
+  /* Past the end of the script, so nothing is held. */
+  return 0;
+}
+
+
+/*
+ * InputScript::get_length - returns the total number of frames scripted.
+ */
+
+uint32_t InputScript::get_length( void )
+{
+  uint32_t l_length = 0;
+
+  for ( const auto &l_run : this->m_runs )
+  {
+    l_length += l_run.frames;
+  }
+  return l_length;
+}
+
+
+/*
+ * HostHarness::set_script - assigns the input script to play; the harness
+ *                           does not take ownership of it.
+ */
+
+void HostHarness::set_script( InputScript *p_script )
+{
+  this->m_script = p_script;
+}
+
+
+/*
+ * HostHarness::set_paced - decides if frames are paced at 40Hz, as on the
+ *                          device; turn it off to run as fast as we can.
+ */
+
+void HostHarness::set_paced( bool p_paced )
+{
+  this->m_paced = p_paced;
+}
+
+
+/*
+ * HostHarness::start - launches the game, just as the SDK does on boot.
+ */
+
+void HostHarness::start( void )
+{
+  picosystem::_io = picosystem::_lio = 0xffffffff;
+  xip_flush();
+  init();
+  this->m_tick = 0;
+  this->m_started = true;
+}
+
+
+/*
+ * HostHarness::step - runs a single frame; samples the buttons, then updates
+ *                     and draws, timing both.
+ */
+
+frame_timing_t HostHarness::step( void )
+{
+  frame_timing_t            l_timing;
+  uint32_t                  l_start_us;
+  picosystem::host_stats_t  l_stats;
+  xip_stats_t               l_xip;
+
+  /* Make sure we've actually been started. */
+  if ( !this->m_started )
+  {
+    this->start();
+  }
+
+  /* Wait for the next frame to come around, as the SDK would. */
+  while ( this->m_paced &&
+          (int32_t)( this->m_next_frame_us - picosystem::time_us() ) > 0 )
+  {
+    picosystem::sleep( 1 );
+  }
+  this->m_next_frame_us = picosystem::time_us() + HOST_FRAME_US;
+
+  /* Buttons are active low, and the SDK keeps the last frame's for pressed() */
+  l_timing.frame = this->m_tick;
+  l_timing.buttons = this->m_script ? this->m_script->get_buttons( this->m_tick ) : 0;
+  picosystem::_lio = picosystem::_io;
+  picosystem::_io = ~l_timing.buttons;
+
+  /* Update, then draw, timing both and counting what gets drawn. */
+  l_stats = picosystem::_host_stats;
+  xip_get_stats( l_xip );
+  l_start_us = picosystem::time_us();
+  update( this->m_tick );
+  l_timing.update_us = picosystem::time_us() - l_start_us;
+
+  l_start_us = picosystem::time_us();
+  draw( this->m_tick );
+  l_timing.draw_us = picosystem::time_us() - l_start_us;
+  l_timing.render = picosystem::host_stats_delta( picosystem::_host_stats, l_stats );
+  xip_get_stats( l_timing.xip );
+  l_timing.xip = xip_stats_delta( l_xip, l_timing.xip );
+
+  /* Remember which state we ended up drawing. */
+  l_timing.state = get_current_state() ? get_current_state()->get_state() : GAMESTATE_MAX;
+  this->m_tick++;
+
+  /* All done. */
+  return l_timing;
+}
+
+
+/*
+ * HostHarness::get_tick - returns the number of frames run so far.
+ */
+
+uint32_t HostHarness::get_tick( void )
+{
+  return this->m_tick;
+}
+
+
+/* End of file host/harness.cpp */
@@ -0,0 +1,95 @@
+/*
+ * host/harness.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file defines the host harness; it stands in for the SDK's main loop,
+ * driving the game's init/update/draw functions one frame at a time with
+ * scripted input, and timing each phase as it goes.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "picosystem.hpp"
+#include "picovaders.hpp"
+#include "utils/xip.hpp"
+
+/* Button masks, as held in input scripts; one bit per SDK button. */
+
+#define HOST_BUTTON(b)  ( 1U << picosystem::b )
+
+/* The SDK runs its main loop at 40Hz; we pace ourselves to match. */
+
+#define HOST_FRAME_US   25000
+
+struct input_run_t
+{
+  uint32_t      frames;
+  uint32_t      buttons;
+};
+
+struct frame_timing_t
+{
+  uint32_t      frame;
+  gamestate_t   state;
+  uint32_t      buttons;
+  uint32_t      update_us;
+  uint32_t      draw_us;
+  picosystem::host_stats_t render;
+  xip_stats_t   xip;
+};
+
+/*
+ * InputScript - a run-length list of held buttons; each run holds a set of
+ *               buttons for a number of frames. Once the script runs out,
+ *               no buttons are held.
+ */
+
+class InputScript
+{
+private:
+  std::vector<input_run_t>  m_runs;
+
+public:
+  bool            load( const char * );
+  bool            parse( const char * );
+  void            add( uint32_t, uint32_t );
+  uint32_t        get_buttons( uint32_t );
+  uint32_t        get_length( void );
+};
+
+/*
+ * HostHarness - runs the game one frame at a time.
+ */
+
+class HostHarness
+{
+private:
+  InputScript    *m_script = nullptr;
+  uint32_t        m_tick = 0;
+  uint32_t        m_next_frame_us = 0;
+  bool            m_started = false;
+  bool            m_paced = true;
+
+public:
+  void            set_script( InputScript * );
+  void            set_paced( bool );
+  void            start( void );
+  frame_timing_t  step( void );
+  uint32_t        get_tick( void );
+};
+
+bool              host_load_file( const char *, std::vector<uint8_t> & );
+bool              host_save_file( const char *, const uint8_t *, uint32_t );
+uint32_t          host_framebuffer_hash( void );
+bool              host_save_ppm( const char * );
+bool              host_save_heatmap( const char *, const uint32_t *, uint32_t );
+uint32_t          host_parse_buttons( const char * );
+bool              host_parse_clock( const char * );
+
+
+/* End of file host/harness.hpp */
@@ -0,0 +1,219 @@
+/*
+ * host/hashlog.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file implements the HashLog class; a stream of per-frame state hashes,
+ * which can be saved, loaded and compared against another stream to find
+ * where two runs of the game diverged.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "hashlog.hpp"
+
+
+/* Module variables. */
+
+static const char *m_field_names[HASH_FIELD_MAX] = {
+  "state", "sheet", "formation", "explosions", "player", "score", "tickers"
+};
+
+
+/* Functions. */
+
+/*
+ * hashlog_field_name - returns the printable name of a hashed field.
+ */
+
+const char *hashlog_field_name( uint_fast8_t p_field )
+{
+  return p_field < HASH_FIELD_MAX ? m_field_names[p_field] : "unknown";
+}
+
+
+/*
+ * clear - empties the log.
+ */
+
+void HashLog::clear( void )
+{
+  this->m_frames.clear();
+}
+
+
+/*
+ * add - appends a frame's hashes, chaining them onto the previous frame's.
+ */
+
+void HashLog::add( const state_hash_t &p_state )
+{
+  hash_frame_t l_frame;
+
+  l_frame.chain = this->m_frames.empty() ? 0 : this->m_frames.back().chain;
+  for ( uint32_t l_field : p_state.field )
+  {
+    l_frame.chain = ( ( l_frame.chain << 5 ) | ( l_frame.chain >> 27 ) ) ^ l_field;
+    l_frame.chain *= 0x9e3779b1U;
+  }
+  l_frame.state = p_state;
+  this->m_frames.push_back( l_frame );
+}
+
+
+/*
+ * load - reads a log written by save; returns false if it can't be read, or
+ *        wasn't written in this format.
+ */
+
+bool HashLog::load( const char *p_filename )
+{
+  FILE         *l_file;
+  char          l_line[256], *l_cursor;
+  hash_frame_t  l_frame;
+
+  l_file = fopen( p_filename, "r" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+
+  /* A log in any other format would just be read as zeros. */
+  this->clear();
+  if ( fgets( l_line, sizeof( l_line ), l_file ) == nullptr )
+  {
+    l_line[0] = '\0';
+  }
+  l_line[strcspn( l_line, "\r\n" )] = '\0';
+  if ( strcmp( l_line, HASHLOG_HEADER ) != 0 )
+  {
+    fclose( l_file );
+    return false;
+  }
+  while ( fgets( l_line, sizeof( l_line ), l_file ) != nullptr )
+  {
+    /* Skip comments and headers. */
+    if ( l_line[0] == '#' || l_line[0] == '\n' )
+    {
+      continue;
+    }
+
+    /* Each line is the frame number, the chain, then each field. */
+    strtoul( l_line, &l_cursor, 10 );
+    l_frame.chain = strtoul( l_cursor, &l_cursor, 16 );
+    for ( uint32_t &l_field : l_frame.state.field )
+    {
+      l_field = strtoul( l_cursor, &l_cursor, 16 );
+    }
+    this->m_frames.push_back( l_frame );
+  }
+  fclose( l_file );
+
+  /* All done. */
+  return true;
+}
+
+
+/*
+ * save - writes the log out as text, one frame to a line.
+ */
+
+bool HashLog::save( const char *p_filename )
+{
+  FILE         *l_file;
+  uint32_t      l_frame = 0;
+
+  l_file = fopen( p_filename, "w" );
+  if ( l_file == nullptr )
+  {
+    return false;
+  }
+
+  fprintf( l_file, "%s\n# frame chain", HASHLOG_HEADER );
+  for ( uint_fast8_t l_field = 0; l_field < HASH_FIELD_MAX; l_field++ )
+  {
+    fprintf( l_file, " %s", hashlog_field_name( l_field ) );
+  }
+  fprintf( l_file, "\n" );
+
+  for ( const hash_frame_t &l_entry : this->m_frames )
+  {
+    fprintf( l_file, "%u %08x", l_frame++, l_entry.chain );
+    for ( uint32_t l_field : l_entry.state.field )
+    {
+      fprintf( l_file, " %08x", l_field );
+    }
+    fprintf( l_file, "\n" );
+  }
+
+  return fclose( l_file ) == 0;
+}
+
+
+/*
+ * get_length - returns the number of frames in the log.
+ */
+
+uint32_t HashLog::get_length( void )
+{
+  return this->m_frames.size();
+}
+
+
+/*
+ * get_frame - returns the hashes for a single frame.
+ */
+
+const hash_frame_t &HashLog::get_frame( uint32_t p_frame )
+{
+  return this->m_frames[p_frame];
+}
+
+
+/*
+ * find_divergence - finds the first frame at which two logs differ, or -1
+ *                   if they're the same. Because the chain hash carries any
+ *                   difference forward, we can bisect rather than scan.
+ */
+
+int64_t HashLog::find_divergence( HashLog &p_other )
+{
+  uint32_t  l_low = 0, l_high, l_mid;
+
+  /* Only compare the frames both logs have. */
+  l_high = this->get_length() < p_other.get_length() ? this->get_length() : p_other.get_length();
+
+  /* If the last common frame matches, the only difference can be length. */
+  if ( l_high == 0 || this->m_frames[l_high - 1].chain == p_other.m_frames[l_high - 1].chain )
+  {
+    return this->get_length() == p_other.get_length() ? -1 : (int64_t)l_high;
+  }
+
+  /* Bisect; the first mismatching chain lies somewhere in [low, high). */
+  l_high--;
+  while ( l_low < l_high )
+  {
+    l_mid = l_low + ( l_high - l_low ) / 2;
+    if ( this->m_frames[l_mid].chain == p_other.m_frames[l_mid].chain )
+    {
+      l_low = l_mid + 1;
+    }
+    else
+    {
+      l_high = l_mid;
+    }
+  }
+
+  /* All done. */
+  return l_low;
+}
+
+
+/* End of file host/hashlog.cpp */
@@ -0,0 +1,48 @@
+/*
+ * host/hashlog.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file defines the HashLog class; a stream of per-frame state hashes,
+ * which can be saved, loaded and compared against another stream to find
+ * where two runs of the game diverged.
+ *
+ * Each frame also carries a chain hash, folding in every frame before it, so
+ * the first divergence can be found by bisection.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "probe.hpp"
+
+#define HASHLOG_HEADER  "# picovaders state hashes v1"
+
+struct hash_frame_t
+{
+  uint32_t      chain;
+  state_hash_t  state;
+};
+
+class HashLog
+{
+private:
+  std::vector<hash_frame_t> m_frames;
+
+public:
+  void                clear( void );
+  void                add( const state_hash_t & );
+  bool                load( const char * );
+  bool                save( const char * );
+  uint32_t            get_length( void );
+  const hash_frame_t &get_frame( uint32_t );
+  int64_t             find_divergence( HashLog & );
+};
+
+const char           *hashlog_field_name( uint_fast8_t );
+
+
+/* End of file host/hashlog.hpp */
@@ -0,0 +1,82 @@
+/*
+ * host/logdump.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This is the entry point for the binary log decoder; it reads a raw log, as
+ * saved by the host runner's --log option, and formats every entry in it.
+ * The game itself never pays for any of this formatting.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "harness.hpp"
+#include "utils/binlog.hpp"
+
+
+/* Functions. */
+
+/*
+ * main - decodes the log named on the command line.
+ */
+
+int main( int argc, char **argv )
+{
+  std::vector<uint8_t>  l_log;
+  binlog_entry_t        l_entry;
+  uint32_t              l_header, l_offset, l_count = 0, l_last_us = 0;
+  char                  l_buffer[128];
+
+  if ( argc != 2 )
+  {
+    fprintf( stderr, "Usage: %s LOGFILE\n", argv[0] );
+    return 1;
+  }
+  if ( !host_load_file( argv[1], l_log ) ||
+       l_log.size() < strlen( BINLOG_MAGIC ) ||
+       memcmp( l_log.data(), BINLOG_MAGIC, strlen( BINLOG_MAGIC ) ) != 0 )
+  {
+    fprintf( stderr, "%s is not a binary log\n", argv[1] );
+    return 1;
+  }
+
+  /* Work through every entry; a header and timestamp, then the arguments. */
+  l_offset = strlen( BINLOG_MAGIC );
+  while ( l_offset + 2 * sizeof( uint32_t ) <= l_log.size() )
+  {
+    memcpy( &l_header, &l_log[l_offset], sizeof( l_header ) );
+    memcpy( &l_entry.time_us, &l_log[l_offset + 4], sizeof( l_entry.time_us ) );
+    l_entry.format = l_header & 0xffff;
+    l_entry.argc = l_header >> 16;
+    l_offset += 2 * sizeof( uint32_t );
+    if ( l_entry.argc > BINLOG_MAX_ARGS ||
+         l_offset + l_entry.argc * sizeof( uint32_t ) > l_log.size() )
+    {
+      fprintf( stderr, "Log is corrupt after %u entries\n", l_count );
+      return 1;
+    }
+    memcpy( l_entry.args, &l_log[l_offset], l_entry.argc * sizeof( uint32_t ) );
+    l_offset += l_entry.argc * sizeof( uint32_t );
+
+    /* Format it, with the time since the previous entry alongside. */
+    binlog_format( l_entry, l_buffer, sizeof( l_buffer ) );
+    printf( "%10u %+9d  %-12s %s\n", l_entry.time_us,
+            l_count ? (int32_t)( l_entry.time_us - l_last_us ) : 0,
+            binlog_format_name( l_entry.format ), l_buffer );
+    l_last_us = l_entry.time_us;
+    l_count++;
+  }
+
+  /* All done. */
+  return 0;
+}
+
+
+/* End of file host/logdump.cpp */
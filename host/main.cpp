@@ -0,0 +1,582 @@
+/*
+ * host/main.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                for the PicoSystem.
+ *
+ * This is the entry point for the headless host build; it runs the game for
+ * a number of frames with scripted input, and reports how long each frame
+ * spent in update and draw.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "harness.hpp"
+#include "hashlog.hpp"
+#include "utils/binlog.hpp"
+#include "utils/clock.hpp"
+#include "utils/console.hpp"
+#include "utils/flight.hpp"
+#include "utils/heap.hpp"
+#include "utils/power.hpp"
+#include "utils/replay.hpp"
+#include "utils/stack.hpp"
+#include "utils/trace.hpp"
+#include "utils/tunables.hpp"
+
+
+/* Constants. */
+
+#define RECORDING_CAPACITY  ( 1024 * 1024 )
+
+
+/* Structures. */
+
+struct state_summary_t
+{
+  uint32_t  frames;
+  uint64_t  update_total_us, draw_total_us;
+  uint32_t  update_max_us, draw_max_us;
+  picosystem::host_stats_t render;
+  xip_stats_t xip;
+  uint32_t  xip_max_misses;
+};
+
+
+/* Functions. */
+
+/*
+ * usage - explains how to run us.
+ */
+
+static void usage( const char *p_name )
+{
+  fprintf( stderr, "Usage: %s [options]\n", p_name );
+  fprintf( stderr, "  --frames N       run for N frames (default 1000)\n" );
+  fprintf( stderr, "  --script FILE    read the input script from FILE\n" );
+  fprintf( stderr, "  --input TEXT     inline input script, runs separated by ';'\n" );
+  fprintf( stderr, "  --csv FILE       write per-frame timings to FILE\n" );
+  fprintf( stderr, "  --clock MODE     realtime (default), fixed[:ms] or unthrottled[:ms]\n" );
+  fprintf( stderr, "  --record FILE    record the buttons and deltas of every frame to FILE\n" );
+  fprintf( stderr, "  --replay FILE    play back a recording; runs for its length by default\n" );
+  fprintf( stderr, "  --hashes FILE    write per-frame simulation state hashes to FILE\n" );
+  fprintf( stderr, "  --ppm DIR        dump frames into DIR as PPM images\n" );
+  fprintf( stderr, "  --ppm-every N    only dump every Nth frame (default 1)\n" );
+  fprintf( stderr, "  --heatmap FILE   write an overdraw heatmap of the whole run to FILE (PPM)\n" );
+  fprintf( stderr, "  --flight FILE    write the flight recorder to FILE when a frame overruns,\n" );
+  fprintf( stderr, "                   and once more at the end of the run\n" );
+  fprintf( stderr, "  --flight-budget US  dump the flight recorder on frames over US (default 25000)\n" );
+  fprintf( stderr, "  --log FILE       save the binary log to FILE, for picovaders_log to decode\n" );
+  fprintf( stderr, "  --set NAME=VALUE change a tunable (see 'set' in the console for the list)\n" );
+  fprintf( stderr, "  --console        read debug console commands from stdin as the game runs\n" );
+  fprintf( stderr, "  --stack          measure the stack depth of each state's update and draw\n" );
+  fprintf( stderr, "  --governor       skip drawing unchanged frames, and count the time that\n" );
+  fprintf( stderr, "                   the device would sleep\n" );
+  fprintf( stderr, "  --strict-heap    abort if GameState allocates while running\n" );
+  fprintf( stderr, "  --trace FILE     write trace zones to FILE as Chrome trace-event JSON\n" );
+}
+
+
+/*
+ * main - parses the command line, then runs the game.
+ */
+
+int main( int argc, char **argv )
+{
+  HostHarness     l_harness;
+  InputScript     l_script;
+  frame_timing_t  l_timing;
+  state_summary_t l_summary[GAMESTATE_MAX+1] = {};
+  uint32_t        l_frames = 0;
+  const char     *l_csv_name = nullptr, *l_record_name = nullptr;
+  const char     *l_hashes_name = nullptr, *l_ppm_dir = nullptr;
+  const char     *l_trace_name = nullptr, *l_heatmap_name = nullptr;
+  const char     *l_flight_name = nullptr, *l_log_name = nullptr;
+  uint32_t        l_flight_budget_us = FLIGHT_DEFAULT_BUDGET_US;
+  std::vector<uint32_t> l_heatmap;
+  uint32_t        l_ppm_every = 1;
+  char            l_ppm_name[256];
+  HashLog         l_hashes;
+  state_hash_t    l_hash;
+  std::vector<uint8_t> l_recording, l_replay;
+  InputRecorder  *l_recorder = nullptr;
+  InputPlayer    *l_player = nullptr;
+  FILE           *l_csv = nullptr, *l_trace = nullptr, *l_flight = nullptr;
+  FILE           *l_log = nullptr;
+  uint32_t        l_start_us, l_elapsed_us;
+
+  /* Work through the arguments. */
+  for ( int l_arg = 1; l_arg < argc; l_arg++ )
+  {
+    if ( strcmp( argv[l_arg], "--frames" ) == 0 && l_arg + 1 < argc )
+    {
+      l_frames = strtoul( argv[++l_arg], nullptr, 10 );
+    }
+    else if ( strcmp( argv[l_arg], "--script" ) == 0 && l_arg + 1 < argc )
+    {
+      if ( !l_script.load( argv[++l_arg] ) )
+      {
+        fprintf( stderr, "Unable to read input script %s\n", argv[l_arg] );
+        return 1;
+      }
+    }
+    else if ( strcmp( argv[l_arg], "--input" ) == 0 && l_arg + 1 < argc )
+    {
+      if ( !l_script.parse( argv[++l_arg] ) )
+      {
+        fprintf( stderr, "Unable to parse input script '%s'\n", argv[l_arg] );
+        return 1;
+      }
+    }
+    else if ( strcmp( argv[l_arg], "--csv" ) == 0 && l_arg + 1 < argc )
+    {
+      l_csv_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--hashes" ) == 0 && l_arg + 1 < argc )
+    {
+      l_hashes_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--ppm" ) == 0 && l_arg + 1 < argc )
+    {
+      l_ppm_dir = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--ppm-every" ) == 0 && l_arg + 1 < argc )
+    {
+      l_ppm_every = strtoul( argv[++l_arg], nullptr, 10 );
+      if ( l_ppm_every == 0 )
+      {
+        l_ppm_every = 1;
+      }
+    }
+    else if ( strcmp( argv[l_arg], "--flight" ) == 0 && l_arg + 1 < argc )
+    {
+      l_flight_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--flight-budget" ) == 0 && l_arg + 1 < argc )
+    {
+      l_flight_budget_us = strtoul( argv[++l_arg], nullptr, 10 );
+    }
+    else if ( strcmp( argv[l_arg], "--log" ) == 0 && l_arg + 1 < argc )
+    {
+      l_log_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--set" ) == 0 && l_arg + 1 < argc )
+    {
+      if ( !tunable_parse( argv[++l_arg] ) )
+      {
+        fprintf( stderr, "Unable to set tunable '%s'\n", argv[l_arg] );
+        return 1;
+      }
+    }
+    else if ( strcmp( argv[l_arg], "--console" ) == 0 )
+    {
+      console_enable( true );
+    }
+    else if ( strcmp( argv[l_arg], "--stack" ) == 0 )
+    {
+      stack_enable( true );
+    }
+    else if ( strcmp( argv[l_arg], "--governor" ) == 0 )
+    {
+      power_enable( true );
+    }
+    else if ( strcmp( argv[l_arg], "--strict-heap" ) == 0 )
+    {
+      heap_set_strict( true );
+    }
+    else if ( strcmp( argv[l_arg], "--heatmap" ) == 0 && l_arg + 1 < argc )
+    {
+      l_heatmap_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--trace" ) == 0 && l_arg + 1 < argc )
+    {
+      l_trace_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--record" ) == 0 && l_arg + 1 < argc )
+    {
+      l_record_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--replay" ) == 0 && l_arg + 1 < argc )
+    {
+      if ( !host_load_file( argv[++l_arg], l_replay ) )
+      {
+        fprintf( stderr, "Unable to read recording %s\n", argv[l_arg] );
+        return 1;
+      }
+    }
+    else if ( strcmp( argv[l_arg], "--clock" ) == 0 && l_arg + 1 < argc )
+    {
+      if ( !host_parse_clock( argv[++l_arg] ) )
+      {
+        fprintf( stderr, "Unknown clock mode %s\n", argv[l_arg] );
+        return 1;
+      }
+    }
+    else
+    {
+      usage( argv[0] );
+      return 1;
+    }
+  }
+
+  /* Set up playback and recording, if asked to. */
+  if ( !l_replay.empty() )
+  {
+    l_player = new InputPlayer( l_replay.data(), l_replay.size() );
+    if ( !l_player->valid() )
+    {
+      fprintf( stderr, "Not a valid recording\n" );
+      return 1;
+    }
+    if ( l_frames == 0 )
+    {
+      l_frames = l_player->count_frames();
+    }
+    set_input_player( l_player );
+  }
+  if ( l_record_name != nullptr )
+  {
+    l_recording.resize( RECORDING_CAPACITY );
+    l_recorder = new InputRecorder( l_recording.data(), l_recording.size() );
+    set_input_recorder( l_recorder );
+  }
+  if ( l_frames == 0 )
+  {
+    l_frames = 1000;
+  }
+
+  /* Open up the CSV output, if we want it. */
+  if ( l_csv_name != nullptr )
+  {
+    l_csv = fopen( l_csv_name, "w" );
+    if ( l_csv == nullptr )
+    {
+      fprintf( stderr, "Unable to write to %s\n", l_csv_name );
+      return 1;
+    }
+    fprintf( l_csv, "frame,state,buttons,update_us,draw_us,"
+                    "sprites,blits,pixel_calls,texts,clears,pixels,blended,"
+                    "xip_hits,xip_misses\n" );
+  }
+
+  /* And the trace; zones are only recorded if they were compiled in. */
+  if ( l_trace_name != nullptr )
+  {
+#ifndef PICOVADERS_TRACE
+    fprintf( stderr, "Trace zones are not compiled in; build with PICOVADERS_TRACE (or Debug)\n" );
+    return 1;
+#endif
+    l_trace = fopen( l_trace_name, "w" );
+    if ( l_trace == nullptr )
+    {
+      fprintf( stderr, "Unable to write to %s\n", l_trace_name );
+      return 1;
+    }
+    trace_write_begin( l_trace );
+  }
+  trace_clear();
+
+  /* The flight recorder is always running; we just decide where it goes. */
+  if ( l_flight_name != nullptr )
+  {
+    l_flight = fopen( l_flight_name, "w" );
+    if ( l_flight == nullptr )
+    {
+      fprintf( stderr, "Unable to write to %s\n", l_flight_name );
+      return 1;
+    }
+    flight_set_output( l_flight );
+    flight_set_budget( l_flight_budget_us );
+  }
+
+  /* The binary log is saved raw, exactly as the game wrote it. */
+  if ( l_log_name != nullptr )
+  {
+    l_log = fopen( l_log_name, "wb" );
+    if ( l_log == nullptr )
+    {
+      fprintf( stderr, "Unable to write to %s\n", l_log_name );
+      return 1;
+    }
+    fwrite( BINLOG_MAGIC, 1, strlen( BINLOG_MAGIC ), l_log );
+  }
+
+  /* Count every write to the screen, if we want a heatmap. */
+  if ( l_heatmap_name != nullptr )
+  {
+    l_heatmap.assign( picosystem::SCREEN->w * picosystem::SCREEN->h, 0 );
+    picosystem::_host_heatmap = l_heatmap.data();
+  }
+
+  /* Now just run the frames, gathering the timings as we go. */
+  l_harness.set_script( &l_script );
+  l_harness.set_paced( get_clock()->get_mode() == CLOCK_REALTIME );
+  l_harness.start();
+  l_start_us = picosystem::time_us();
+  for ( uint32_t l_frame = 0; l_frame < l_frames; l_frame++ )
+  {
+    l_timing = l_harness.step();
+    if ( l_log != nullptr )
+    {
+      binlog_drain_raw( l_log );
+    }
+    if ( l_trace != nullptr )
+    {
+      trace_write_events( l_trace );
+    }
+    else
+    {
+      trace_clear();
+    }
+    if ( l_hashes_name != nullptr )
+    {
+      StateProbe::hash_state( get_current_state(), l_hash );
+      l_hashes.add( l_hash );
+    }
+    if ( l_ppm_dir != nullptr && l_timing.frame % l_ppm_every == 0 )
+    {
+      snprintf( l_ppm_name, sizeof( l_ppm_name ), "%s/frame_%05u.ppm", l_ppm_dir, l_timing.frame );
+      if ( !host_save_ppm( l_ppm_name ) )
+      {
+        fprintf( stderr, "Unable to write %s\n", l_ppm_name );
+        return 1;
+      }
+    }
+
+    state_summary_t &l_state = l_summary[l_timing.state];
+    l_state.frames++;
+    l_state.update_total_us += l_timing.update_us;
+    l_state.draw_total_us += l_timing.draw_us;
+    if ( l_timing.update_us > l_state.update_max_us )
+    {
+      l_state.update_max_us = l_timing.update_us;
+    }
+    if ( l_timing.draw_us > l_state.draw_max_us )
+    {
+      l_state.draw_max_us = l_timing.draw_us;
+    }
+    l_state.render.pixels += l_timing.render.pixels;
+    l_state.render.blended += l_timing.render.blended;
+    l_state.render.sprites += l_timing.render.sprites;
+    l_state.render.blits += l_timing.render.blits;
+    l_state.render.pixel_calls += l_timing.render.pixel_calls;
+    l_state.render.texts += l_timing.render.texts;
+    l_state.render.clears += l_timing.render.clears;
+    l_state.xip.bytes += l_timing.xip.bytes;
+    l_state.xip.hits += l_timing.xip.hits;
+    l_state.xip.misses += l_timing.xip.misses;
+    l_state.xip_max_misses = std::max( l_state.xip_max_misses, l_timing.xip.misses );
+
+    if ( l_csv != nullptr )
+    {
+      fprintf( l_csv, "%u,%s,0x%08x,%u,%u,%u,%u,%u,%u,%u,%llu,%llu,%u,%u\n", l_timing.frame,
+               gamestate_name( l_timing.state ), l_timing.buttons,
+               l_timing.update_us, l_timing.draw_us,
+               l_timing.render.sprites, l_timing.render.blits,
+               l_timing.render.pixel_calls, l_timing.render.texts,
+               l_timing.render.clears, (unsigned long long)l_timing.render.pixels,
+               (unsigned long long)l_timing.render.blended,
+               l_timing.xip.hits, l_timing.xip.misses );
+    }
+  }
+  l_elapsed_us = picosystem::time_us() - l_start_us;
+
+  /* Save the heatmap, if we wanted one. */
+  if ( l_heatmap_name != nullptr )
+  {
+    picosystem::_host_heatmap = nullptr;
+    if ( !host_save_heatmap( l_heatmap_name, l_heatmap.data(), l_frames ) )
+    {
+      fprintf( stderr, "Unable to write heatmap to %s\n", l_heatmap_name );
+      return 1;
+    }
+  }
+
+  /* Save the state hashes, if we wanted them. */
+  if ( l_hashes_name != nullptr && !l_hashes.save( l_hashes_name ) )
+  {
+    fprintf( stderr, "Unable to write hashes to %s\n", l_hashes_name );
+    return 1;
+  }
+
+  /* Save the recording, if we made one. */
+  if ( l_recorder != nullptr )
+  {
+    set_input_recorder( nullptr );
+    if ( l_recorder->overflowed() )
+    {
+      fprintf( stderr, "Recording ran out of space after %u frames\n", l_recorder->get_frames() );
+    }
+    if ( !host_save_file( l_record_name, l_recording.data(), l_recorder->finish() ) )
+    {
+      fprintf( stderr, "Unable to write recording to %s\n", l_record_name );
+      return 1;
+    }
+    delete l_recorder;
+  }
+  if ( l_player != nullptr )
+  {
+    set_input_player( nullptr );
+    delete l_player;
+  }
+  if ( l_csv != nullptr )
+  {
+    fclose( l_csv );
+  }
+  if ( l_trace != nullptr )
+  {
+    trace_write_end( l_trace );
+    fclose( l_trace );
+  }
+  if ( l_log != nullptr )
+  {
+    fclose( l_log );
+    if ( binlog_get_dropped() > 0 )
+    {
+      fprintf( stderr, "%u log entries were dropped\n", binlog_get_dropped() );
+    }
+  }
+  if ( l_flight != nullptr )
+  {
+    flight_dump( "end of run" );
+    flight_set_output( nullptr );
+    fclose( l_flight );
+    printf( "%u frames over the %uus flight recorder budget\n",
+            flight_get_overruns(), l_flight_budget_us );
+  }
+
+  /* And summarise it, state by state. */
+  printf( "%-8s %8s %12s %12s %12s %12s\n", "state", "frames",
+          "update avg", "update max", "draw avg", "draw max" );
+  for ( int l_state = 0; l_state <= GAMESTATE_MAX; l_state++ )
+  {
+    const state_summary_t &l_state_summary = l_summary[l_state];
+    if ( l_state_summary.frames == 0 )
+    {
+      continue;
+    }
+    printf( "%-8s %8u %10.1fus %10uus %10.1fus %10uus\n",
+            gamestate_name( (gamestate_t)l_state ), l_state_summary.frames,
+            (double)l_state_summary.update_total_us / l_state_summary.frames,
+            l_state_summary.update_max_us,
+            (double)l_state_summary.draw_total_us / l_state_summary.frames,
+            l_state_summary.draw_max_us );
+  }
+
+  /* Then what each state draws, on average, per frame. */
+  printf( "\n%-8s %8s %8s %8s %8s %8s %10s %10s %9s\n", "state", "sprites",
+          "blits", "pixel()", "texts", "clears", "pixels", "blended", "overdraw" );
+  for ( int l_state = 0; l_state <= GAMESTATE_MAX; l_state++ )
+  {
+    const state_summary_t &l_state_summary = l_summary[l_state];
+    if ( l_state_summary.frames == 0 )
+    {
+      continue;
+    }
+    double l_frames_d = l_state_summary.frames;
+    printf( "%-8s %8.1f %8.1f %8.1f %8.1f %8.2f %10.0f %10.0f %8.2fx\n",
+            gamestate_name( (gamestate_t)l_state ),
+            l_state_summary.render.sprites / l_frames_d,
+            l_state_summary.render.blits / l_frames_d,
+            l_state_summary.render.pixel_calls / l_frames_d,
+            l_state_summary.render.texts / l_frames_d,
+            l_state_summary.render.clears / l_frames_d,
+            l_state_summary.render.pixels / l_frames_d,
+            l_state_summary.render.blended / l_frames_d,
+            l_state_summary.render.pixels / l_frames_d /
+              ( picosystem::SCREEN->w * picosystem::SCREEN->h ) );
+  }
+
+  /* How the assets fared in the XIP cache, per frame. */
+  printf( "\n%-8s %10s %10s %10s %9s %10s %10s\n", "xip", "bytes", "hits", "misses",
+          "hit rate", "max misses", "stall" );
+  for ( int l_state = 0; l_state <= GAMESTATE_MAX; l_state++ )
+  {
+    const state_summary_t &l_state_summary = l_summary[l_state];
+    if ( l_state_summary.frames == 0 )
+    {
+      continue;
+    }
+    double l_frames_d = l_state_summary.frames;
+    uint32_t l_lookups = l_state_summary.xip.hits + l_state_summary.xip.misses;
+    printf( "%-8s %10.0f %10.1f %10.1f %8.1f%% %10u %8.1fus\n",
+            gamestate_name( (gamestate_t)l_state ),
+            l_state_summary.xip.bytes / l_frames_d,
+            l_state_summary.xip.hits / l_frames_d,
+            l_state_summary.xip.misses / l_frames_d,
+            l_lookups ? 100.0 * l_state_summary.xip.hits / l_lookups : 100.0,
+            l_state_summary.xip_max_misses,
+            xip_stall_us( l_state_summary.xip ) / l_frames_d );
+  }
+
+  /* How long it took to switch into each state. */
+  printf( "\n%-8s %8s %10s %10s %10s\n", "switch", "count", "avg", "last", "max" );
+  for ( int l_state = 0; l_state < GAMESTATE_MAX; l_state++ )
+  {
+    const transition_stats_t *l_switch = get_transition_stats( (gamestate_t)l_state );
+    if ( l_switch == nullptr || l_switch->count == 0 )
+    {
+      continue;
+    }
+    printf( "%-8s %8u %8.1fus %8uus %8uus\n", gamestate_name( (gamestate_t)l_state ),
+            l_switch->count, (double)l_switch->total_us / l_switch->count,
+            l_switch->last_us, l_switch->max_us );
+  }
+
+  /* How deep the stack went, if we were watching. */
+  if ( stack_enabled() )
+  {
+    printf( "\n%-8s %10s %10s\n", "stack", "update", "draw" );
+    for ( int l_state = 0; l_state < GAMESTATE_MAX; l_state++ )
+    {
+      if ( l_summary[l_state].frames == 0 )
+      {
+        continue;
+      }
+      printf( "%-8s %9ub %9ub\n", gamestate_name( (gamestate_t)l_state ),
+              stack_get_max( (gamestate_t)l_state, STACK_UPDATE ),
+              stack_get_max( (gamestate_t)l_state, STACK_DRAW ) );
+    }
+    printf( "high water %ub, of a %ub thread stack; %ub was already in use on entry\n",
+            stack_get_high_water(), stack_get_size(), stack_get_base() );
+  }
+
+  /* And what each state did with the heap. */
+  printf( "\n%-8s %8s %8s %8s %10s %10s %10s\n", "heap", "allocs", "frees",
+          "blocks", "live", "peak", "largest" );
+  for ( int l_state = 0; l_state <= GAMESTATE_MAX; l_state++ )
+  {
+    heap_stats_t l_heap;
+    heap_get_stats( (gamestate_t)l_state, l_heap );
+    if ( l_heap.allocs == 0 )
+    {
+      continue;
+    }
+    printf( "%-8s %8u %8u %8u %9ub %9ub %9ub\n",
+            l_state == GAMESTATE_MAX ? "(none)" : gamestate_name( (gamestate_t)l_state ),
+            l_heap.allocs, l_heap.frees, l_heap.live_blocks,
+            l_heap.live_bytes, l_heap.peak_bytes, l_heap.largest_block );
+  }
+
+  /* How busy each state kept the core, and how much of it could be slept. */
+  printf( "\n" );
+  power_describe( stdout );
+
+  /* And how fast the whole thing ran, against simulated time. */
+  printf( "\n%u frames, %.3fs simulated in %.3fs (%.0f frames/s)\n", l_frames,
+          get_clock()->get_time() / 1000.0, l_elapsed_us / 1000000.0,
+          l_elapsed_us ? l_frames * 1000000.0 / l_elapsed_us : 0.0 );
+
+  /* All done. */
+  return 0;
+}
+
+
+/* End of file host/main.cpp */
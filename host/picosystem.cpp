@@ -0,0 +1,471 @@
+/*
+ * host/picosystem.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                      for the PicoSystem.
+ *
+ * This file implements the software stand-in for the PicoSystem SDK; it draws
+ * into an in-memory 240x240 framebuffer, reads buttons from a bitmask that the
+ * host harness sets each frame, and takes time from the host's steady clock.
+ *
+ * It is not a faithful copy of the SDK's internals, just of its behaviour as
+ * far as the game can see it.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <chrono>
+#include <thread>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/xip.hpp"
+
+
+/* Constants. */
+
+#define HOST_SCREEN_SIZE  240
+#define FONT_FIRST_CHAR   32
+#define FONT_LAST_CHAR    95
+#define FONT_SCALE        2
+#define FONT_ADVANCE      ( 4 * FONT_SCALE )
+#define FONT_LINE_HEIGHT  ( 6 * FONT_SCALE )
+
+/*
+ * A tiny 3x5 font, one glyph per entry, five rows of three bits from the top;
+ * it's drawn at FONT_SCALE, and lower case letters borrow the upper case ones.
+ */
+
+static const uint16_t m_font[] = {
+  0x0000, 0x2482, 0x5a00, 0x5f7d, 0x3c9e, 0x52a5, 0x2aab, 0x2400,
+  0x1491, 0x4494, 0x0aa8, 0x05d0, 0x0014, 0x01c0, 0x0002, 0x12a4,
+  0x7b6f, 0x2c97, 0x73e7, 0x72cf, 0x5bc9, 0x79cf, 0x79ef, 0x7292,
+  0x7bef, 0x7bcf, 0x0410, 0x0414, 0x1511, 0x0e38, 0x4454, 0x7282,
+  0x2be3, 0x2bed, 0x6bae, 0x3923, 0x6b6e, 0x79a7, 0x79a4, 0x396b,
+  0x5bed, 0x7497, 0x126a, 0x5bad, 0x4927, 0x5fed, 0x6b6d, 0x2b6a,
+  0x6ba4, 0x2b73, 0x6bad, 0x388e, 0x7492, 0x5b6b, 0x5b52, 0x5bfd,
+  0x5aad, 0x5a92, 0x72a7, 0x6926, 0x4889, 0x324b, 0x2a00, 0x0007,
+};
+
+
+namespace picosystem {
+
+  /* Module variables. */
+
+  static color_t        m_screen_data[HOST_SCREEN_SIZE * HOST_SCREEN_SIZE];
+  static buffer_t       m_screen = { HOST_SCREEN_SIZE, HOST_SCREEN_SIZE, m_screen_data, false };
+  static int32_t        m_cursor_x, m_cursor_y;
+  static const auto     m_epoch = std::chrono::steady_clock::now();
+
+  color_t               _pen = 0;
+  blend_func_t          _bf = ALPHA;
+  buffer_t             *SCREEN = &m_screen;
+  buffer_t             *_dt = &m_screen;
+  buffer_t             *_ss = nullptr;
+  uint32_t              _io = 0xffffffff, _lio = 0xffffffff;
+  host_stats_t          _host_stats = {};
+  uint32_t             *_host_heatmap = nullptr;
+
+
+  /* Colour helpers; channels are stored as GBAR nibbles. */
+
+  static inline uint8_t chan_r( color_t c ) { return c & 0xf; }
+  static inline uint8_t chan_a( color_t c ) { return ( c >> 4 ) & 0xf; }
+  static inline uint8_t chan_b( color_t c ) { return ( c >> 8 ) & 0xf; }
+  static inline uint8_t chan_g( color_t c ) { return ( c >> 12 ) & 0xf; }
+
+  color_t rgb( uint8_t r, uint8_t g, uint8_t b, uint8_t a )
+  {
+    return ( r & 0xf ) | ( ( a & 0xf ) << 4 ) | ( ( b & 0xf ) << 8 ) | ( ( g & 0xf ) << 12 );
+  }
+
+  /*
+   * mix - blends a source colour over a destination one, using the given
+   *       alpha (0-15).
+   */
+
+  static color_t mix( color_t s, color_t d, uint8_t a )
+  {
+    if ( a == 0 )
+    {
+      return d;
+    }
+    if ( a >= 15 )
+    {
+      return s | 0x00f0;
+    }
+
+    return rgb( chan_r( d ) + ( chan_r( s ) - chan_r( d ) ) * a / 15,
+                chan_g( d ) + ( chan_g( s ) - chan_g( d ) ) * a / 15,
+                chan_b( d ) + ( chan_b( s ) - chan_b( d ) ) * a / 15,
+                a + chan_a( d ) * ( 15 - a ) / 15 );
+  }
+
+
+  /*
+   * count_span - tallies a span of writes; if it lands on the screen and we're
+   *              keeping a heatmap, each pixel of it is counted there too.
+   */
+
+  static inline void count_span( const color_t *pd, uint32_t c )
+  {
+    _host_stats.pixels += c;
+    if ( _host_heatmap != nullptr && pd >= m_screen_data &&
+         pd < m_screen_data + HOST_SCREEN_SIZE * HOST_SCREEN_SIZE )
+    {
+      uint32_t *l_cell = _host_heatmap + ( pd - m_screen_data );
+      while ( c-- )
+      {
+        ( *l_cell++ )++;
+      }
+    }
+  }
+
+
+  /* Blend modes. */
+
+  void COPY( const color_t *ps, uint32_t so, uint32_t ss, color_t *pd, uint32_t c )
+  {
+    count_span( pd, c );
+    while ( c-- )
+    {
+      *pd++ = ps[so >> 16];
+      so += ss;
+    }
+  }
+
+  void ALPHA( const color_t *ps, uint32_t so, uint32_t ss, color_t *pd, uint32_t c )
+  {
+    count_span( pd, c );
+    _host_stats.blended += c;
+    while ( c-- )
+    {
+      color_t s = ps[so >> 16];
+      *pd = mix( s, *pd, chan_a( s ) );
+      pd++;
+      so += ss;
+    }
+  }
+
+  void MASK( const color_t *ps, uint32_t so, uint32_t ss, color_t *pd, uint32_t c )
+  {
+    count_span( pd, c );
+    while ( c-- )
+    {
+      color_t s = ps[so >> 16];
+      if ( chan_a( s ) )
+      {
+        *pd = s;
+      }
+      pd++;
+      so += ss;
+    }
+  }
+
+  void PEN( const color_t *ps, uint32_t so, uint32_t ss, color_t *pd, uint32_t c )
+  {
+    count_span( pd, c );
+    _host_stats.blended += c;
+    while ( c-- )
+    {
+      color_t s = ps[so >> 16];
+      *pd = mix( _pen, *pd, chan_a( s ) * chan_a( _pen ) / 15 );
+      pd++;
+      so += ss;
+    }
+  }
+
+
+  /* Drawing state. */
+
+  void pen( uint8_t r, uint8_t g, uint8_t b, uint8_t a )
+  {
+    _pen = rgb( r, g, b, a );
+  }
+  void pen( color_t p )
+  {
+    _pen = p;
+  }
+  void pen( void )
+  {
+    _pen = 0;
+  }
+
+  void blend( blend_func_t bf )
+  {
+    _bf = bf;
+  }
+
+  void target( buffer_t *dt )
+  {
+    _dt = dt;
+    m_cursor_x = m_cursor_y = 0;
+  }
+  void target( void )
+  {
+    target( SCREEN );
+  }
+
+  void spritesheet( buffer_t *ss )
+  {
+    _ss = ss;
+  }
+  void spritesheet( void )
+  {
+    _ss = nullptr;
+  }
+
+
+  /* Primitives. */
+
+  void clear( void )
+  {
+    if ( _dt == SCREEN )
+    {
+      _host_stats.clears++;
+    }
+    for ( int32_t y = 0; y < _dt->h; y++ )
+    {
+      _bf( &_pen, 0, 0, _dt->p( 0, y ), _dt->w );
+    }
+  }
+
+  void pixel( int32_t x, int32_t y )
+  {
+    _host_stats.pixel_calls++;
+    if ( x < 0 || y < 0 || x >= _dt->w || y >= _dt->h )
+    {
+      return;
+    }
+    _bf( &_pen, 0, 0, _dt->p( x, y ), 1 );
+  }
+
+  /*
+   * span - fills a clipped horizontal run with the pen.
+   */
+
+  static void span( int32_t x, int32_t y, int32_t w )
+  {
+    if ( y < 0 || y >= _dt->h )
+    {
+      return;
+    }
+    if ( x < 0 )
+    {
+      w += x;
+      x = 0;
+    }
+    if ( x + w > _dt->w )
+    {
+      w = _dt->w - x;
+    }
+    if ( w > 0 )
+    {
+      _bf( &_pen, 0, 0, _dt->p( x, y ), w );
+    }
+  }
+
+  void frect( int32_t x, int32_t y, int32_t w, int32_t h )
+  {
+    for ( int32_t l_y = y; l_y < y + h; l_y++ )
+    {
+      span( x, l_y, w );
+    }
+  }
+
+  void text( const std::string &t, int32_t x, int32_t y )
+  {
+    int32_t l_x = x;
+
+    _host_stats.texts++;
+
+    for ( char c : t )
+    {
+      if ( c == '\n' )
+      {
+        l_x = x;
+        y += FONT_LINE_HEIGHT;
+        continue;
+      }
+      if ( c >= 'a' && c <= 'z' )
+      {
+        c -= 'a' - 'A';
+      }
+      if ( c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR )
+      {
+        c = '?';
+      }
+
+      uint16_t l_glyph = m_font[c - FONT_FIRST_CHAR];
+      for ( int32_t row = 0; row < 5; row++ )
+      {
+        for ( int32_t col = 0; col < 3; col++ )
+        {
+          if ( l_glyph & ( 0x4000 >> ( row * 3 + col ) ) )
+          {
+            for ( int32_t sy = 0; sy < FONT_SCALE; sy++ )
+            {
+              span( l_x + col * FONT_SCALE, y + row * FONT_SCALE + sy, FONT_SCALE );
+            }
+          }
+        }
+      }
+      l_x += FONT_ADVANCE;
+    }
+  }
+  void text( const std::string &t )
+  {
+    text( t, m_cursor_x, m_cursor_y );
+    m_cursor_y += FONT_LINE_HEIGHT;
+  }
+
+  void measure( const std::string &t, int32_t &w, int32_t &h )
+  {
+    int32_t l_line = 0;
+
+    w = 0;
+    h = FONT_LINE_HEIGHT;
+    for ( char c : t )
+    {
+      if ( c == '\n' )
+      {
+        l_line = 0;
+        h += FONT_LINE_HEIGHT;
+        continue;
+      }
+      l_line += FONT_ADVANCE;
+      if ( l_line - FONT_SCALE > w )
+      {
+        w = l_line - FONT_SCALE;
+      }
+    }
+  }
+
+  /*
+   * draw_blit - copies a (scaled) block of the source buffer onto the target,
+   *             clipped to the target; sprites and blits both come here.
+   */
+
+  static void draw_blit( buffer_t *src, int32_t x, int32_t y, int32_t w, int32_t h,
+                         int32_t dx, int32_t dy, int32_t dw, int32_t dh )
+  {
+    if ( src == nullptr || w <= 0 || h <= 0 || dw <= 0 || dh <= 0 )
+    {
+      return;
+    }
+
+    /* Work out the horizontal step, and clip the destination run. */
+    uint32_t l_step = ( (uint32_t)w << 16 ) / dw;
+    int32_t  l_x0 = dx < 0 ? 0 : dx;
+    int32_t  l_x1 = ( dx + dw ) > _dt->w ? _dt->w : ( dx + dw );
+    if ( l_x0 >= l_x1 )
+    {
+      return;
+    }
+    uint32_t l_so = ( (uint32_t)x << 16 ) + ( l_x0 - dx ) * l_step;
+    uint32_t l_sx0 = l_so >> 16;
+    uint32_t l_sx1 = ( l_so + ( l_x1 - l_x0 - 1 ) * l_step ) >> 16;
+
+    for ( int32_t l_dy = dy < 0 ? 0 : dy; l_dy < dy + dh && l_dy < _dt->h; l_dy++ )
+    {
+      int32_t l_sy = y + ( l_dy - dy ) * h / dh;
+      XIP_READ( src->p( l_sx0, l_sy ), ( l_sx1 - l_sx0 + 1 ) * sizeof( color_t ) );
+      _bf( src->p( 0, l_sy ), l_so, l_step, _dt->p( l_x0, l_dy ), l_x1 - l_x0 );
+    }
+  }
+
+  void sprite( uint32_t i, int32_t x, int32_t y )
+  {
+    _host_stats.sprites++;
+    if ( _ss == nullptr )
+    {
+      return;
+    }
+    uint32_t l_per_row = _ss->w / 8;
+    draw_blit( _ss, ( i % l_per_row ) * 8, ( i / l_per_row ) * 8, 8, 8, x, y, 8, 8 );
+  }
+
+  void blit( buffer_t *src, int32_t x, int32_t y, int32_t w, int32_t h, int32_t dx, int32_t dy )
+  {
+    _host_stats.blits++;
+    draw_blit( src, x, y, w, h, dx, dy, w, h );
+  }
+
+  void blit( buffer_t *src, int32_t x, int32_t y, int32_t w, int32_t h,
+             int32_t dx, int32_t dy, int32_t dw, int32_t dh )
+  {
+    _host_stats.blits++;
+    draw_blit( src, x, y, w, h, dx, dy, dw, dh );
+  }
+
+
+  /* Utility. */
+
+  buffer_t *buffer( uint32_t w, uint32_t h, void *data )
+  {
+    buffer_t *l_buffer = new buffer_t();
+    l_buffer->w = w;
+    l_buffer->h = h;
+    if ( data != nullptr )
+    {
+      l_buffer->data = (color_t *)data;
+      l_buffer->alloc = false;
+    }
+    else
+    {
+      l_buffer->data = new color_t[w * h]();
+      l_buffer->alloc = true;
+    }
+    return l_buffer;
+  }
+
+  uint32_t time( void )
+  {
+    return time_us() / 1000;
+  }
+
+  uint32_t time_us( void )
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - m_epoch ).count();
+  }
+
+  void sleep( uint32_t d )
+  {
+    std::this_thread::sleep_for( std::chrono::milliseconds( d ) );
+  }
+
+  bool pressed( uint32_t b )
+  {
+    return !( _io & ( 1U << b ) ) && ( _lio & ( 1U << b ) );
+  }
+
+  bool button( uint32_t b )
+  {
+    return !( _io & ( 1U << b ) );
+  }
+
+
+  /* Host-only extensions. */
+
+  host_stats_t host_stats_delta( const host_stats_t &after, const host_stats_t &before )
+  {
+    host_stats_t l_delta;
+
+    l_delta.pixels = after.pixels - before.pixels;
+    l_delta.blended = after.blended - before.blended;
+    l_delta.sprites = after.sprites - before.sprites;
+    l_delta.blits = after.blits - before.blits;
+    l_delta.pixel_calls = after.pixel_calls - before.pixel_calls;
+    l_delta.texts = after.texts - before.texts;
+    l_delta.clears = after.clears - before.clears;
+    return l_delta;
+  }
+
+}
+
+
+/* End of file host/picosystem.cpp */
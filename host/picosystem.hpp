@@ -0,0 +1,124 @@
+/*
+ * host/picosystem.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                      for the PicoSystem.
+ *
+ * This file defines a software stand-in for the subset of the PicoSystem SDK
+ * that the game uses, so that the game can be built and run headless on a
+ * Linux host. The API mirrors the real SDK; anything the game itself calls
+ * must exist in the real thing too!
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+/* System headers. */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+
+/* The three entry points that the game provides to the SDK. */
+
+void init( void );
+void update( uint32_t );
+void draw( uint32_t );
+
+
+namespace picosystem {
+
+  /* Colours are 4 bits per channel, packed the same way the SDK does. */
+  typedef uint16_t color_t;
+
+  struct buffer_t
+  {
+    int32_t   w, h;
+    color_t  *data;
+    bool      alloc;
+
+    color_t  *p( int32_t x, int32_t y ) { return data + ( x + y * w ); }
+             ~buffer_t() { if ( alloc ) delete[] data; }
+  };
+
+  /* Blend functions work on a span; source offset and step are 16.16 fixed. */
+  using blend_func_t = void(*)( const color_t *, uint32_t, uint32_t, color_t *, uint32_t );
+
+  enum button
+  {
+    UP = 23, DOWN = 20, LEFT = 22, RIGHT = 21,
+    A = 18, B = 19, X = 17, Y = 16
+  };
+
+  /* Blend modes. */
+  void      COPY( const color_t *, uint32_t, uint32_t, color_t *, uint32_t );
+  void      ALPHA( const color_t *, uint32_t, uint32_t, color_t *, uint32_t );
+  void      MASK( const color_t *, uint32_t, uint32_t, color_t *, uint32_t );
+  void      PEN( const color_t *, uint32_t, uint32_t, color_t *, uint32_t );
+
+  /* Drawing state. */
+  extern color_t        _pen;
+  extern blend_func_t   _bf;
+  extern buffer_t      *SCREEN;
+  extern buffer_t      *_dt;
+  extern buffer_t      *_ss;
+  extern uint32_t       _io, _lio;
+
+  color_t   rgb( uint8_t, uint8_t, uint8_t, uint8_t = 15 );
+  void      pen( uint8_t, uint8_t, uint8_t, uint8_t = 15 );
+  void      pen( color_t );
+  void      pen( void );
+  void      blend( blend_func_t = ALPHA );
+  void      target( buffer_t * );
+  void      target( void );
+  void      spritesheet( buffer_t * );
+  void      spritesheet( void );
+
+  /* Primitives. */
+  void      clear( void );
+  void      pixel( int32_t, int32_t );
+  void      frect( int32_t, int32_t, int32_t, int32_t );
+  void      text( const std::string &, int32_t, int32_t );
+  void      text( const std::string & );
+  void      measure( const std::string &, int32_t &, int32_t & );
+  void      sprite( uint32_t, int32_t, int32_t );
+  void      blit( buffer_t *, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t );
+  void      blit( buffer_t *, int32_t, int32_t, int32_t, int32_t,
+                  int32_t, int32_t, int32_t, int32_t );
+
+  /* Utility. */
+  buffer_t *buffer( uint32_t, uint32_t, void * = nullptr );
+  uint32_t  time( void );
+  uint32_t  time_us( void );
+  void      sleep( uint32_t );
+  bool      pressed( uint32_t );
+  bool      button( uint32_t );
+
+  /*
+   * Host-only extensions; the game itself must never use these! The render
+   * counters only ever go up, so callers take the difference across whatever
+   * they're measuring. The overdraw heatmap, if one is set, counts the writes
+   * to each pixel of the screen (not of other targets).
+   */
+  struct host_stats_t
+  {
+    uint64_t  pixels;             /* Pixels passed through any blend mode. */
+    uint64_t  blended;            /* ... of which, by ALPHA or PEN.        */
+    uint32_t  sprites;
+    uint32_t  blits;
+    uint32_t  pixel_calls;
+    uint32_t  texts;
+    uint32_t  clears;             /* Clears of the whole screen.           */
+  };
+
+  extern host_stats_t   _host_stats;
+  extern uint32_t      *_host_heatmap;
+
+  host_stats_t  host_stats_delta( const host_stats_t &, const host_stats_t & );
+
+}
+
+
+/* End of file host/picosystem.hpp */
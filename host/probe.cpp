@@ -0,0 +1,235 @@
+/*
+ * host/probe.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                 for the PicoSystem.
+ *
+ * This file implements the StateProbe class; host tooling uses it to reach into
+ * the private parts of the state objects, to set up fixtures and to inspect
+ * the simulation. The states name it as a friend, and nothing else.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+
+/* Local headers. */
+
+#include "probe.hpp"
+
+
+/* Constants. */
+
+#define FNV_OFFSET  2166136261U
+#define FNV_PRIME   16777619U
+
+
+/* Functions. */
+
+/*
+ * fnv - folds a value into an FNV-1a hash, a byte at a time. Values are
+ *       always hashed as 32 bits, whatever their native size.
+ */
+
+static void fnv( uint32_t &p_hash, uint32_t p_value )
+{
+  for ( uint_fast8_t l_byte = 0; l_byte < 4; l_byte++ )
+  {
+    p_hash = ( p_hash ^ ( ( p_value >> ( l_byte * 8 ) ) & 0xff ) ) * FNV_PRIME;
+  }
+}
+
+
+/*
+ * hash_state - hashes the whole simulation state, a field at a time; states
+ *              other than the game hash what little they have in HASH_STATE.
+ */
+
+void StateProbe::hash_state( GameStateInterface *p_state, state_hash_t &p_hash )
+{
+  GameState    *l_game;
+  SplashState  *l_splash;
+  TitleState   *l_title;
+
+  /* Start everything off empty. */
+  for ( uint32_t &l_field : p_hash.field )
+  {
+    l_field = FNV_OFFSET;
+  }
+  if ( p_state == nullptr )
+  {
+    return;
+  }
+
+  fnv( p_hash.field[HASH_STATE], p_state->get_state() );
+  switch( p_state->get_state() )
+  {
+    case GAMESTATE_SPLASH:
+      l_splash = static_cast<SplashState *>( p_state );
+      fnv( p_hash.field[HASH_STATE], l_splash->m_time_ms );
+      break;
+
+    case GAMESTATE_TITLE:
+      l_title = static_cast<TitleState *>( p_state );
+      fnv( p_hash.field[HASH_STATE], l_title->m_time_ms );
+      fnv( p_hash.field[HASH_STATE], l_title->m_invader_offset );
+      fnv( p_hash.field[HASH_STATE], l_title->m_invader_ltor );
+      fnv( p_hash.field[HASH_TICKERS], l_title->m_scheduler.get_count( l_title->m_invader_timer ) );
+      break;
+
+    case GAMESTATE_GAME:
+      l_game = static_cast<GameState *>( p_state );
+      fnv( p_hash.field[HASH_STATE], l_game->m_time_ms );
+      fnv( p_hash.field[HASH_STATE], l_game->m_pending_ms );
+      for ( uint_fast8_t l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
+      {
+        for ( uint_fast8_t l_column = 0; l_column < SHEET_WIDTH; l_column++ )
+        {
+          fnv( p_hash.field[HASH_SHEET], l_game->m_invaders[l_row][l_column] );
+        }
+      }
+      fnv( p_hash.field[HASH_FORMATION], l_game->m_invader_offset );
+      fnv( p_hash.field[HASH_FORMATION], l_game->m_invader_descent );
+      fnv( p_hash.field[HASH_FORMATION], l_game->m_invader_ltor );
+      for ( uint_fast8_t l_index = 0; l_index < MAX_EXPLOSIONS; l_index++ )
+      {
+        const explosion_t &l_explosion = l_game->m_explosion_list[l_index];
+        fnv( p_hash.field[HASH_EXPLOSIONS], l_explosion.sprite );
+        if ( l_explosion.sprite != 0 )
+        {
+          fnv( p_hash.field[HASH_EXPLOSIONS], l_explosion.x );
+          fnv( p_hash.field[HASH_EXPLOSIONS], l_explosion.y );
+          fnv( p_hash.field[HASH_EXPLOSIONS], l_explosion.wide );
+        }
+      }
+      fnv( p_hash.field[HASH_PLAYER], l_game->m_player_base_loc.x );
+      fnv( p_hash.field[HASH_PLAYER], l_game->m_player_base_loc.y );
+      fnv( p_hash.field[HASH_PLAYER], l_game->m_player_firing );
+      if ( l_game->m_player_firing )
+      {
+        fnv( p_hash.field[HASH_PLAYER], l_game->m_player_bullet_loc.x );
+        fnv( p_hash.field[HASH_PLAYER], l_game->m_player_bullet_loc.y );
+      }
+      fnv( p_hash.field[HASH_SCORE], l_game->m_score );
+      fnv( p_hash.field[HASH_TICKERS], l_game->m_scheduler.get_count( GAME_TIMER_INVADER ) );
+      fnv( p_hash.field[HASH_TICKERS], l_game->m_scheduler.get_count( GAME_TIMER_BASE ) );
+      fnv( p_hash.field[HASH_TICKERS], l_game->m_scheduler.get_count( GAME_TIMER_BULLET ) );
+      fnv( p_hash.field[HASH_TICKERS], l_game->m_scheduler.get_count( GAME_TIMER_EXPLOSION ) );
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+
+/*
+ * clear_alternate - clears every other invader from the sheet, in a check
+ *                   pattern, leaving it half full.
+ */
+
+void StateProbe::clear_alternate( GameState *p_game )
+{
+  for ( uint_fast8_t l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
+  {
+    for ( uint_fast8_t l_column = 0; l_column < SHEET_WIDTH; l_column++ )
+    {
+      if ( ( l_row + l_column ) % 2 )
+      {
+        p_game->m_invaders[l_row][l_column] = INVADER_NONE;
+      }
+    }
+  }
+  p_game->m_sheet_dirty = true;
+}
+
+
+/*
+ * fill_explosions - fills every slot in the explosion list with a wide
+ *                   explosion, spread across the sheet.
+ */
+
+void StateProbe::fill_explosions( GameState *p_game )
+{
+  coord_t l_location;
+
+  for ( uint_fast8_t l_index = 0; l_index < MAX_EXPLOSIONS; l_index++ )
+  {
+    l_location = p_game->get_invader_location( l_index % SHEET_WIDTH,
+                                               l_index / SHEET_WIDTH );
+    p_game->m_explosion_list[l_index].x = l_location.x;
+    p_game->m_explosion_list[l_index].y = l_location.y;
+    p_game->m_explosion_list[l_index].sprite = SPRITE_BIG_BOOM;
+    p_game->m_explosion_list[l_index].wide = true;
+  }
+}
+
+
+/*
+ * count_invaders - returns how many invaders are left on the sheet.
+ */
+
+uint_fast8_t StateProbe::count_invaders( GameState *p_game )
+{
+  uint_fast8_t l_count = 0;
+
+  for ( uint_fast8_t l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
+  {
+    for ( uint_fast8_t l_column = 0; l_column < SHEET_WIDTH; l_column++ )
+    {
+      if ( p_game->m_invaders[l_row][l_column] != INVADER_NONE )
+      {
+        l_count++;
+      }
+    }
+  }
+  return l_count;
+}
+
+
+/*
+ * count_explosions - returns how many explosions are currently active.
+ */
+
+uint_fast8_t StateProbe::count_explosions( GameState *p_game )
+{
+  uint_fast8_t l_count = 0;
+
+  for ( uint_fast8_t l_index = 0; l_index < MAX_EXPLOSIONS; l_index++ )
+  {
+    if ( p_game->m_explosion_list[l_index].sprite != 0 )
+    {
+      l_count++;
+    }
+  }
+  return l_count;
+}
+
+
+/*
+ * get_player - returns the location of the player's base.
+ */
+
+coord_t StateProbe::get_player( GameState *p_game )
+{
+  return p_game->m_player_base_loc;
+}
+
+
+/*
+ * set_splash_time, set_title_time - moves a state to a given point in its
+ *                                   animation.
+ */
+
+void StateProbe::set_splash_time( SplashState *p_splash, uint_fast16_t p_time_ms )
+{
+  p_splash->m_time_ms = p_time_ms;
+}
+void StateProbe::set_title_time( TitleState *p_title, uint_fast32_t p_time_ms )
+{
+  p_title->m_time_ms = p_time_ms;
+}
+
+
+/* End of file host/probe.cpp */
@@ -0,0 +1,55 @@
+/*
+ * host/probe.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                 for the PicoSystem.
+ *
+ * This file defines the StateProbe class; host tooling uses it to reach into
+ * the private parts of the state objects, to set up fixtures and to inspect
+ * the simulation. The states name it as a friend, and nothing else.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#include "picosystem.hpp"
+#include "picovaders.hpp"
+#include "state/game.hpp"
+#include "state/splash.hpp"
+#include "state/title.hpp"
+
+/* The separately hashed parts of the simulation. */
+
+typedef enum
+{
+  HASH_STATE,
+  HASH_SHEET,
+  HASH_FORMATION,
+  HASH_EXPLOSIONS,
+  HASH_PLAYER,
+  HASH_SCORE,
+  HASH_TICKERS,
+  HASH_FIELD_MAX
+} hashfield_t;
+
+struct state_hash_t
+{
+  uint32_t  field[HASH_FIELD_MAX];
+};
+
+class StateProbe
+{
+public:
+  static void         hash_state( GameStateInterface *, state_hash_t & );
+
+  static void         clear_alternate( GameState * );
+  static void         fill_explosions( GameState * );
+  static uint_fast8_t count_invaders( GameState * );
+  static uint_fast8_t count_explosions( GameState * );
+  static coord_t      get_player( GameState * );
+  static void         set_splash_time( SplashState *, uint_fast16_t );
+  static void         set_title_time( TitleState *, uint_fast32_t );
+};
+
+
+/* End of file host/probe.hpp */
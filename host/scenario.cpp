@@ -0,0 +1,344 @@
+/*
+ * host/scenario.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                    for the PicoSystem.
+ *
+ * This is the entry point for the host scenario benchmarks; each scenario runs
+ * a fixed input script through the whole game, as fast as it can, recording
+ * the distribution of frame times and of pixels drawn. If the 99th percentile
+ * frame is over either of the scenario's budgets, the run fails.
+ *
+ * Pixel counts are exact, so their budget is tight. Frame times depend on the
+ * host and whatever else it's doing; their budget is loose, and a scenario
+ * that goes over it is run again before it's failed.
+ *
+ * Results are written as JSON, so that two builds can be compared.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+
+/* Local headers. */
+
+#include "harness.hpp"
+#include "probe.hpp"
+#include "utils/clock.hpp"
+
+
+/* Constants. */
+
+#define SCENARIO_ATTEMPTS 3
+
+/* Sits through the splash screen, and starts the game from the title. */
+#define SCRIPT_START    "84 -; 2 X; 4 -;"
+
+/* Sweeps back and forth across the screen, firing all the time. */
+#define SCRIPT_SWEEP    "100 LEFT A; 220 RIGHT A; 220 LEFT A; 220 RIGHT A; 120 LEFT A;"
+
+
+/* Structures. */
+
+struct scenario_t
+{
+  const char   *name;
+  const char   *script;
+  uint32_t      frames;
+  uint32_t      budget_p99_us;
+  uint32_t      budget_p99_pixels;
+  bool        (*done)( void );
+  void        (*hook)( void );
+};
+
+struct percentiles_t
+{
+  uint32_t      p50, p99, max;
+  double        mean;
+};
+
+struct scenario_run_t
+{
+  uint32_t      frames;
+  bool          finished;
+  percentiles_t update, draw, frame, pixels;
+  picosystem::host_stats_t render;
+};
+
+
+/* Functions. */
+
+/*
+ * get_game - returns the running GameState, if that's where we are.
+ */
+
+static GameState *get_game( void )
+{
+  GameStateInterface *l_state = get_current_state();
+
+  if ( l_state == nullptr || l_state->get_state() != GAMESTATE_GAME )
+  {
+    return nullptr;
+  }
+  return static_cast<GameState *>( l_state );
+}
+
+
+/*
+ * wave_cleared - ends a scenario once every invader has been shot.
+ */
+
+static bool wave_cleared( void )
+{
+  GameState *l_game = get_game();
+
+  return l_game != nullptr && StateProbe::count_invaders( l_game ) == 0;
+}
+
+
+/*
+ * explosion_storm - keeps the explosion list full, every frame.
+ */
+
+static void explosion_storm( void )
+{
+  GameState *l_game = get_game();
+
+  if ( l_game != nullptr )
+  {
+    StateProbe::fill_explosions( l_game );
+  }
+}
+
+
+/* Module variables. */
+
+static const scenario_t m_scenarios[] = {
+  { "splash_to_game",  SCRIPT_START "200 -",
+    300, 3000, 75000, nullptr, nullptr },
+  { "wave_clear",      SCRIPT_START SCRIPT_SWEEP SCRIPT_SWEEP SCRIPT_SWEEP SCRIPT_SWEEP
+                       SCRIPT_SWEEP SCRIPT_SWEEP SCRIPT_SWEEP SCRIPT_SWEEP,
+    8000, 2000, 68000, wave_cleared, nullptr },
+  { "explosion_storm", SCRIPT_START SCRIPT_SWEEP,
+    1000, 3000, 70000, nullptr, explosion_storm },
+};
+
+
+/*
+ * summarise - works out the percentiles of a set of timings.
+ */
+
+static percentiles_t summarise( std::vector<uint32_t> p_timings )
+{
+  percentiles_t l_result = {};
+  uint64_t      l_total = 0;
+
+  if ( p_timings.empty() )
+  {
+    return l_result;
+  }
+
+  std::sort( p_timings.begin(), p_timings.end() );
+  for ( uint32_t l_timing : p_timings )
+  {
+    l_total += l_timing;
+  }
+  l_result.p50 = p_timings[( p_timings.size() - 1 ) * 50 / 100];
+  l_result.p99 = p_timings[( p_timings.size() - 1 ) * 99 / 100];
+  l_result.max = p_timings.back();
+  l_result.mean = (double)l_total / p_timings.size();
+  return l_result;
+}
+
+
+/*
+ * write_percentiles - writes a set of percentiles as a JSON object.
+ */
+
+static void write_percentiles( FILE *p_file, const char *p_name, const percentiles_t &p_values )
+{
+  fprintf( p_file, "\"%s\": { \"p50\": %u, \"p99\": %u, \"max\": %u, \"mean\": %.1f }",
+           p_name, p_values.p50, p_values.p99, p_values.max, p_values.mean );
+}
+
+
+/*
+ * write_render - writes the average render counters per frame as a JSON object.
+ */
+
+static void write_render( FILE *p_file, const picosystem::host_stats_t &p_render, uint32_t p_frames )
+{
+  double l_frames = p_frames ? p_frames : 1;
+
+  fprintf( p_file, "\"render\": { \"sprites\": %.1f, \"blits\": %.1f, \"pixel_calls\": %.1f, "
+                   "\"texts\": %.1f, \"clears\": %.2f, \"pixels\": %.0f, \"blended\": %.0f }",
+           p_render.sprites / l_frames, p_render.blits / l_frames,
+           p_render.pixel_calls / l_frames, p_render.texts / l_frames,
+           p_render.clears / l_frames, p_render.pixels / l_frames,
+           p_render.blended / l_frames );
+}
+
+
+/*
+ * run_scenario - runs a single scenario from a fresh start, and summarises it.
+ */
+
+static void run_scenario( const scenario_t &p_scenario, scenario_run_t &p_run )
+{
+  HostHarness               l_harness;
+  InputScript               l_script;
+  frame_timing_t            l_timing;
+  picosystem::host_stats_t  l_render_start;
+  std::vector<uint32_t>     l_update_us, l_draw_us, l_frame_us, l_pixels;
+
+  /* Load up the script, and restart the game. */
+  l_script.parse( p_scenario.script );
+  l_harness.set_paced( false );
+  l_harness.set_script( &l_script );
+  l_harness.start();
+  l_render_start = picosystem::_host_stats;
+
+  /* Run the frames. */
+  for ( p_run.frames = 0; p_run.frames < p_scenario.frames; p_run.frames++ )
+  {
+    if ( p_scenario.hook != nullptr )
+    {
+      p_scenario.hook();
+    }
+    l_timing = l_harness.step();
+    l_update_us.push_back( l_timing.update_us );
+    l_draw_us.push_back( l_timing.draw_us );
+    l_frame_us.push_back( l_timing.update_us + l_timing.draw_us );
+    l_pixels.push_back( l_timing.render.pixels );
+    if ( p_scenario.done != nullptr && p_scenario.done() )
+    {
+      p_run.frames++;
+      break;
+    }
+  }
+
+  /* Summarise it all. */
+  p_run.finished = p_scenario.done == nullptr || p_scenario.done();
+  p_run.render = picosystem::host_stats_delta( picosystem::_host_stats, l_render_start );
+  p_run.update = summarise( l_update_us );
+  p_run.draw = summarise( l_draw_us );
+  p_run.frame = summarise( l_frame_us );
+  p_run.pixels = summarise( l_pixels );
+  return;
+}
+
+
+/*
+ * main - runs each scenario in turn, and reports on them all.
+ */
+
+int main( int argc, char **argv )
+{
+  scenario_run_t          l_run;
+  const char             *l_filter = nullptr, *l_json_name = nullptr;
+  double                  l_budget_scale = 1.0;
+  uint32_t                l_budget_us, l_attempt;
+  bool                    l_first = true, l_pass, l_all_pass = true;
+  FILE                   *l_json = stdout;
+
+  /* Work through the arguments. */
+  for ( int l_arg = 1; l_arg < argc; l_arg++ )
+  {
+    if ( strcmp( argv[l_arg], "--filter" ) == 0 && l_arg + 1 < argc )
+    {
+      l_filter = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--json" ) == 0 && l_arg + 1 < argc )
+    {
+      l_json_name = argv[++l_arg];
+    }
+    else if ( strcmp( argv[l_arg], "--budget-scale" ) == 0 && l_arg + 1 < argc )
+    {
+      l_budget_scale = strtod( argv[++l_arg], nullptr );
+    }
+    else
+    {
+      fprintf( stderr, "Usage: %s [--filter TEXT] [--json FILE] [--budget-scale F]\n", argv[0] );
+      return 1;
+    }
+  }
+  if ( l_json_name != nullptr )
+  {
+    l_json = fopen( l_json_name, "w" );
+    if ( l_json == nullptr )
+    {
+      fprintf( stderr, "Unable to write to %s\n", l_json_name );
+      return 1;
+    }
+  }
+
+  /* Scenarios run as fast as they can, but in fixed steps. */
+  get_clock()->set_mode( CLOCK_UNTHROTTLED );
+
+  fprintf( l_json, "{ \"scenarios\": [\n" );
+  for ( const scenario_t &l_scenario : m_scenarios )
+  {
+    if ( l_filter != nullptr && strstr( l_scenario.name, l_filter ) == nullptr )
+    {
+      continue;
+    }
+
+    /* The pixels drawn are the same every time; the time taken isn't, so */
+    /* only give up on that once it's been over budget every attempt.      */
+    l_budget_us = l_scenario.budget_p99_us * l_budget_scale;
+    for ( l_attempt = 1; l_attempt <= SCENARIO_ATTEMPTS; l_attempt++ )
+    {
+      run_scenario( l_scenario, l_run );
+      if ( l_run.frame.p99 <= l_budget_us )
+      {
+        break;
+      }
+    }
+    l_attempt = std::min( l_attempt, (uint32_t)SCENARIO_ATTEMPTS );
+
+    l_pass = l_run.frame.p99 <= l_budget_us && l_run.pixels.p99 <= l_scenario.budget_p99_pixels;
+    if ( !l_run.finished )
+    {
+      fprintf( stderr, "%s: did not finish within %u frames\n", l_scenario.name, l_run.frames );
+      l_pass = false;
+    }
+    l_all_pass = l_all_pass && l_pass;
+
+    fprintf( l_json, "%s  { \"name\": \"%s\", \"frames\": %u, \"budget_p99_us\": %u, "
+                     "\"budget_p99_pixels\": %u, \"attempts\": %u, \"pass\": %s,\n    ",
+             l_first ? "" : ",\n", l_scenario.name, l_run.frames, l_budget_us,
+             l_scenario.budget_p99_pixels, l_attempt, l_pass ? "true" : "false" );
+    write_percentiles( l_json, "update_us", l_run.update );
+    fprintf( l_json, ",\n    " );
+    write_percentiles( l_json, "draw_us", l_run.draw );
+    fprintf( l_json, ",\n    " );
+    write_percentiles( l_json, "frame_us", l_run.frame );
+    fprintf( l_json, ",\n    " );
+    write_percentiles( l_json, "pixels", l_run.pixels );
+    fprintf( l_json, ",\n    " );
+    write_render( l_json, l_run.render, l_run.frames );
+    fprintf( l_json, " }" );
+    l_first = false;
+
+    fprintf( stderr, "%-16s %6u frames  p99 %6uus (budget %6uus, %u run%s)  "
+                     "p99 %6u pixels (budget %6u)  %s\n",
+             l_scenario.name, l_run.frames, l_run.frame.p99, l_budget_us, l_attempt,
+             l_attempt == 1 ? "" : "s", l_run.pixels.p99, l_scenario.budget_p99_pixels,
+             l_pass ? "ok" : "FAILED" );
+  }
+  fprintf( l_json, "\n] }\n" );
+  if ( l_json != stdout )
+  {
+    fclose( l_json );
+  }
+
+  /* All done. */
+  return l_all_pass ? 0 : 1;
+}
+
+
+/* End of file host/scenario.cpp */
@@ -11,6 +11,9 @@
 
 /* System headers. */
 
+#include <algorithm>
+#include <new>
+
 /* Local headers. */
 
 #include "picosystem.hpp"
@@ -19,17 +22,73 @@
 #include "state/splash.hpp"
 #include "state/title.hpp"
 #include "assets/spritesheet.hpp"
+#include "utils/binlog.hpp"
+#include "utils/clock.hpp"
+#include "utils/console.hpp"
+#include "utils/flight.hpp"
+#include "utils/heap.hpp"
+#include "utils/power.hpp"
+#include "utils/profiler.hpp"
+#include "utils/replay.hpp"
+#include "utils/stack.hpp"
+#include "utils/trace.hpp"
+#include "utils/xip.hpp"
+
+
+/* Constants. */
+
+/* Only one state exists at a time, so they all share the same storage. */
+static constexpr size_t m_state_size = std::max( { sizeof( SplashState ),
+                                                   sizeof( TitleState ),
+                                                   sizeof( GameState ) } );
+static constexpr size_t m_state_align = std::max( { alignof( SplashState ),
+                                                    alignof( TitleState ),
+                                                    alignof( GameState ) } );
 
 
 /* Module variables. */
 
+alignas( m_state_align ) static uint8_t m_state_storage[m_state_size];
+transition_stats_t  m_transition_stats[GAMESTATE_MAX];
 gamestate_t         m_next_state;
-uint32_t            m_last_frame_ms;
+GameClock           m_clock;
 GameStateInterface *m_current_state = nullptr;
+InputRecorder      *m_input_recorder = nullptr;
+InputPlayer        *m_input_player = nullptr;
 
 
 /* Functions. */
 
+/*
+ * create_state - constructs a state in the shared state storage; it's checked
+ *                at compile time that there's room for it.
+ */
+
+template<typename T>
+static GameStateInterface *create_state( void )
+{
+  static_assert( sizeof( T ) <= sizeof( m_state_storage ), "state storage too small" );
+  static_assert( alignof( T ) <= m_state_align, "state storage not aligned enough" );
+  return new( m_state_storage ) T();
+}
+
+
+/*
+ * destroy_state - tears down the current state, if there is one; the storage
+ *                 is simply left for the next state to reuse.
+ */
+
+static void destroy_state( void )
+{
+  if ( m_current_state != nullptr )
+  {
+    m_current_state->~GameStateInterface();
+    m_current_state = nullptr;
+  }
+  return;
+}
+
+
 /*
  * init - the PicoSystem SDK entry point; called when the game is launched. 
  */
@@ -39,11 +98,31 @@ void init( void )
   /* Set our initial gamestate to the splash screen. */
   m_next_state = GAMESTATE_SPLASH;
 
-  /* Set the last frame time to now. */
-  m_last_frame_ms = picosystem::time();
+  /* Throw away any existing state, so a relaunch really starts from scratch. */
+  destroy_state();
+
+  /* Start the clock from now. */
+  m_clock.reset();
+
+  /* The power governor stays off unless the build asks for it. */
+#ifdef PICOVADERS_POWER
+  power_enable( true );
+#endif
 
-  /* Load up the spritesheet. */
+  /* Debug builds always keep an eye on the stack, and on the device they */
+  /* listen for console commands; the host tools decide that for themselves. */
+#ifdef DEBUG
+  stack_enable( true );
+#ifndef PICOVADERS_HOST
+  console_enable( true );
+#endif
+#endif
+
+  /* Load up the spritesheet; it's read straight out of flash. */
   picosystem::spritesheet( &spritesheet_buffer );
+  XIP_REGION( spritesheet_buffer.data,
+              spritesheet_buffer.w * spritesheet_buffer.h * sizeof( picosystem::color_t ),
+              "spritesheet" );
 
   /* All done. */
   return;
@@ -59,44 +138,99 @@ void init( void )
 
 void update( uint32_t p_tick )
 {
-  uint32_t l_delta, l_current_frame_ms;
+  TRACE_ZONE( "picovaders::update" );
+
+  uint32_t l_delta, l_switch_us, l_update_us;
 
   /* Work out our delta from the last update; this will always be needed. */
-  l_current_frame_ms = picosystem::time();
-  l_delta = l_current_frame_ms - m_last_frame_ms;
-  m_last_frame_ms = l_current_frame_ms;
+  l_delta = m_clock.get_delta();
+  l_update_us = picosystem::time_us();
+
+  /* When replaying a recording, it provides both the delta and the buttons. */
+  if ( m_input_player != nullptr && !m_input_player->apply( l_delta ) )
+  {
+    m_input_player = nullptr;
+  }
+
+  /* And if we're recording, capture exactly what this frame will see. */
+  if ( m_input_recorder != nullptr )
+  {
+    m_input_recorder->record( replay_buttons_from_io( picosystem::_io ), l_delta );
+  }
+
+  /* The debug console gets first say on what happens this frame. */
+#ifdef PICOVADERS_CONSOLE
+  console_poll();
+  if ( console_take_state_request( m_next_state ) )
+  {
+    /* Even if it's the state we're in, it's started over from scratch. */
+    destroy_state();
+  }
+#endif
 
   /* Check to see if we've been requested to switch states. */
   if ( ( m_current_state == nullptr ) ||
        ( m_current_state->get_state() != m_next_state ) )
   {
-    /* If we have a current state, delete it. */
-    if ( m_current_state != nullptr )
-    {
-      delete m_current_state;
-      m_current_state = nullptr;
-    }
+    TRACE_ZONE( "picovaders::switch_state" );
+    l_switch_us = picosystem::time_us();
+    BINLOG( LOG_STATE, m_current_state ? m_current_state->get_state() : GAMESTATE_MAX, m_next_state );
+
+    /* If we have a current state, tear it down. */
+    destroy_state();
 
-    /* Create the right state object now. */
+    /* Create the right state object now; whatever it allocates is its own. */
+    heap_enter_state( m_next_state );
     switch( m_next_state )
     {
       case GAMESTATE_SPLASH:
-        m_current_state = new SplashState();
+        m_current_state = create_state<SplashState>();
         break;
       case GAMESTATE_TITLE:
-        m_current_state = new TitleState();
+        m_current_state = create_state<TitleState>();
         break;
       case GAMESTATE_GAME:
-        m_current_state = new GameState();
+        m_current_state = create_state<GameState>();
+        break;
+      default:
+        /* Death has no state of its own (yet); nothing is constructed, and */
+        /* nothing runs until another state is asked for.                   */
         break;
     }
+    heap_set_running( false );
+
+    /* Keep track of how long that took, so we know it'll never cause a hitch; */
+    /* only if there was a state to switch into, though.                       */
+    if ( m_current_state != nullptr )
+    {
+      transition_stats_t &l_stats = m_transition_stats[m_next_state];
+      l_stats.last_us = picosystem::time_us() - l_switch_us;
+      l_stats.max_us = std::max( l_stats.max_us, l_stats.last_us );
+      l_stats.total_us += l_stats.last_us;
+      l_stats.count++;
+    }
   }
 
-  /* We can now just ask the state object to update itself. */
+  /* The flight recorder keeps a summary of every frame, always. */
+  flight_begin_frame( l_delta, m_current_state ? m_current_state->get_state() : GAMESTATE_MAX );
+  power_begin_frame( l_delta );
+
+  /* We can now just ask the state object to update itself, unless paused. */
+#ifdef PICOVADERS_CONSOLE
+  if ( m_current_state != nullptr && console_should_update() )
+#else
   if ( m_current_state != nullptr )
+#endif
   {
+    PROFILE_BEGIN( PROFILE_UPDATE );
+    heap_set_running( true );
+    STACK_BEGIN();
     m_next_state = m_current_state->update( l_delta );
+    STACK_END( m_current_state->get_state(), STACK_UPDATE );
+    heap_set_running( false );
+    PROFILE_END( PROFILE_UPDATE );
   }
+  flight_set_update( picosystem::time_us() - l_update_us );
 
   /* All done. */
   return;
@@ -111,10 +245,61 @@ void update( uint32_t p_tick )
 
 void draw( uint32_t p_tick )
 {
-  /* Because this is just a render operation, timings and states don't change. */
+  TRACE_ZONE( "picovaders::draw" );
+
+  uint32_t l_draw_us = picosystem::time_us();
+  bool     l_dirty;
+
+  /* Because this is just a render operation, timings and states don't change; */
+  /* and if nothing has changed, the last frame is still there to be shown.    */
   if ( m_current_state != nullptr )
   {
-    m_current_state->draw();
+    l_dirty = m_current_state->is_dirty();
+#ifdef DEBUG
+    l_dirty = l_dirty || profiler_overlay_drawn();
+#endif
+    if ( power_should_draw( l_dirty ) )
+    {
+      PROFILE_BEGIN( PROFILE_DRAW );
+      heap_set_running( true );
+      STACK_BEGIN();
+      m_current_state->draw();
+      STACK_END( m_current_state->get_state(), STACK_DRAW );
+      heap_set_running( false );
+      PROFILE_END( PROFILE_DRAW );
+      m_current_state->mark_drawn();
+    }
+  }
+
+  /* That's the frame done, as far as the flight recorder is concerned. */
+  flight_set_draw( picosystem::time_us() - l_draw_us );
+  flight_end_frame();
+
+  /* In debug builds, show where the time went. */
+#ifdef DEBUG
+  PROFILE_BEGIN( PROFILE_OVERLAY );
+  profiler_draw_overlay();
+  PROFILE_END( PROFILE_OVERLAY );
+#endif
+  PROFILE_FRAME_END();
+
+  /* With everything drawn, there's time to catch up on the log; the host */
+  /* tools save it raw, and decode it later. Only debug builds set up the */
+  /* USB serial port, so release builds don't format anything at all.    */
+#if !defined(PICOVADERS_HOST) && defined(DEBUG)
+  binlog_drain( stdout, BINLOG_IDLE_ENTRIES );
+  flight_drain( FLIGHT_IDLE_LINES );
+#endif
+
+  /* Finally, sleep through any idle time; this has to be the last thing, so */
+  /* the buttons are read as soon as it's over.                              */
+  if ( m_current_state != nullptr )
+  {
+    power_end_frame( m_current_state->get_state(), m_current_state->get_idle_us() );
+  }
+  else
+  {
+    power_end_frame( GAMESTATE_MAX, 0 );
   }
 
   /* All done. */
@@ -122,4 +307,60 @@ void draw( uint32_t p_tick )
 }
 
 
+/*
+ * get_current_state - returns the currently active state object, if there is
+ *                     one; mostly of interest to tooling.
+ */
+
+GameStateInterface *get_current_state( void )
+{
+  return m_current_state;
+}
+
+
+/*
+ * get_transition_stats - returns how long switching into the given state has
+ *                        taken; that is, tearing down the old state and
+ *                        constructing the new one.
+ */
+
+const transition_stats_t *get_transition_stats( gamestate_t p_state )
+{
+  return p_state < GAMESTATE_MAX ? &m_transition_stats[p_state] : nullptr;
+}
+
+
+/*
+ * get_clock - returns the clock which generates our frame deltas, so that it
+ *             can be switched away from real time.
+ */
+
+GameClock *get_clock( void )
+{
+  return &m_clock;
+}
+
+
+/*
+ * set_input_recorder - starts recording every frame's buttons and delta into
+ *                      the recorder provided; pass nullptr to stop.
+ */
+
+void set_input_recorder( InputRecorder *p_recorder )
+{
+  m_input_recorder = p_recorder;
+}
+
+
+/*
+ * set_input_player - plays back a recording, in place of the real buttons
+ *                    and clock; this stops by itself when it runs out.
+ */
+
+void set_input_player( InputPlayer *p_player )
+{
+  m_input_player = p_player;
+}
+
+
 /* End of file picovaders.cpp */
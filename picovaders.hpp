@@ -11,6 +11,11 @@
 
 #pragma once
 
+/* System headers. */
+
+#include <cstdio>
+
+
 /* Constants and enums. */
 
 #define SCREEN_WIDTH    240
@@ -71,6 +76,19 @@ typedef enum
   GAMESTATE_MAX
 } gamestate_t;
 
+/* A printable name for a state, as the console and the tools know it. */
+inline const char *gamestate_name( gamestate_t p_state )
+{
+  switch( p_state )
+  {
+    case GAMESTATE_SPLASH:  return "splash";
+    case GAMESTATE_TITLE:   return "title";
+    case GAMESTATE_GAME:    return "game";
+    case GAMESTATE_DEATH:   return "death";
+    default:                return "none";
+  }
+}
+
 
 /* Structures. */
 
@@ -80,6 +98,14 @@ struct coord_t
   uint_fast8_t y;
 };
 
+struct transition_stats_t
+{
+  uint32_t     count;
+  uint32_t     last_us;
+  uint32_t     max_us;
+  uint32_t     total_us;
+};
+
 
 /* Interfaces. */
 
@@ -87,13 +113,33 @@ class GameStateInterface
 {
   protected:
     gamestate_t   m_state = GAMESTATE_MAX;
+    bool          m_dirty = true;         /* Set when what's drawn changes. */
 
   public:
+    virtual            ~GameStateInterface() {}
     virtual gamestate_t update( uint32_t ) = 0;
     virtual void        draw( void ) = 0;
+    virtual void        describe( FILE * ) {}
+    virtual uint32_t    get_idle_us( void ) { return 0; }
     
     gamestate_t         get_state( void ) { return m_state; }
+    bool                is_dirty( void ) { return m_dirty; }
+    void                mark_drawn( void ) { m_dirty = false; }
+    void                mark_dirty( void ) { m_dirty = true; }
 };
 
 
+/* Functions. */
+
+class GameClock;
+class InputRecorder;
+class InputPlayer;
+
+GameStateInterface     *get_current_state( void );
+const transition_stats_t *get_transition_stats( gamestate_t );
+GameClock              *get_clock( void );
+void                    set_input_recorder( InputRecorder * );
+void                    set_input_player( InputPlayer * );
+
+
 /* End of file picovaders.hpp */
@@ -21,7 +21,11 @@
 #include "picovaders.hpp"
 #include "assets/spritesheet.hpp"
 #include "state/game.hpp"
-#include "utils/tick.hpp"
+#include "utils/binlog.hpp"
+#include "utils/flight.hpp"
+#include "utils/profiler.hpp"
+#include "utils/trace.hpp"
+#include "utils/tunables.hpp"
 
 
 /* Functions. */
@@ -38,11 +42,18 @@ GameState::GameState( void )
   /* And set the timer to zero. */
   this->m_time_ms = 0;
 
-  /* Intialise the various tickers. */
-  this->m_invader_tick = new TickCounter( 400 );
-  this->m_base_tick = new TickCounter( 20 );
-  this->m_bullet_tick = new TickCounter( 10 );
-  this->m_explosion_tick = new TickCounter( 100 );
+  /* Intialise the various timers, in gametimer_t order; when two fall due */
+  /* at the same moment, the one added first goes first.                  */
+  this->m_scheduler.add( SCHEDULER_MS( TUNABLE( EXPLOSION_PERIOD ) ) );
+  this->m_scheduler.add( SCHEDULER_MS( TUNABLE( BULLET_PERIOD ) ) );
+  this->m_scheduler.add( SCHEDULER_MS( TUNABLE( INVADER_PERIOD ) ) );
+  this->m_scheduler.add( SCHEDULER_MS( TUNABLE( BASE_PERIOD ) ) );
+  this->m_scheduler.set_catchup_limit( TUNABLE( CATCHUP_LIMIT ) );
+
+  /* The simulation steps along on its own clock, starting from nothing. */
+  this->m_pending_ms = 0;
+  this->m_dropped_ms = 0;
+  this->m_steps = 0;
 
   /* Position the player roughly in the middle. */
   this->m_player_base_loc.x = ( SCREEN_WIDTH - PLAYER_WIDTH ) / 2;
@@ -64,28 +75,6 @@ GameState::GameState( void )
 
 GameState::~GameState()
 {
-  /* Clean up the tickers. */
-  if ( this->m_invader_tick != nullptr )
-  {
-    delete this->m_invader_tick;
-    this->m_invader_tick = nullptr;
-  }
-  if ( this->m_base_tick != nullptr )
-  {
-    delete this->m_base_tick;
-    this->m_base_tick = nullptr;
-  }
-  if ( this->m_bullet_tick != nullptr )
-  {
-    delete this->m_bullet_tick;
-    this->m_bullet_tick = nullptr;
-  }
-  if ( this->m_explosion_tick != nullptr )
-  {
-    delete this->m_explosion_tick;
-    this->m_explosion_tick = nullptr;
-  }
-
   /* All done. */
   return;
 }
@@ -97,6 +86,8 @@ GameState::~GameState()
 
 void GameState::load_level( void )
 {
+  TRACE_ZONE( "GameState::load_level" );
+
   uint_fast8_t l_index, l_row;
 
   /* Pretty simple stuff; the first row is invader3 and the next two, type 2 */
@@ -120,12 +111,17 @@ void GameState::load_level( void )
   this->m_invader_offset = 0;
   this->m_invader_descent = 20;
   this->m_invader_ltor = true;
+  this->m_sheet_dirty = true;
+  this->m_invader_count = 0;
 
   /* Make sure there aren't lingering explosions. */
   for( l_index = 0; l_index < MAX_EXPLOSIONS; l_index++ )
   {
     this->m_explosion_list[l_index].sprite = 0;
   }
+
+  /* Nothing should slide in from where the last level left off. */
+  this->save_last();
 }
 
 
@@ -143,8 +139,8 @@ coord_t GameState::get_invader_location( uint_fast8_t p_column, uint_fast8_t p_r
   coord_t l_location;
 
   /* Fairly simple sum, but helps to only do it one place! */
-  l_location.x = ( p_column * 20 ) + this->m_invader_offset;
-  l_location.y = ( p_row * 20 ) + this->m_invader_descent;
+  l_location.x = ( p_column * TUNABLE( CELL_PITCH ) ) + this->m_invader_offset;
+  l_location.y = ( p_row * TUNABLE( CELL_PITCH ) ) + this->m_invader_descent;
 
   /* All done. */
   return l_location;
@@ -165,14 +161,134 @@ coord_t GameState::get_invader_position( uint_fast8_t p_x, uint_fast8_t p_y )
   coord_t l_position;
 
   /* Fairly simple sum, but helps to only do it one place! */
-  l_position.x = ( p_x - this->m_invader_offset ) / 20;
-  l_position.y = ( p_y - this->m_invader_descent ) / 20;
+  l_position.x = ( p_x - this->m_invader_offset ) / TUNABLE( CELL_PITCH );
+  l_position.y = ( p_y - this->m_invader_descent ) / TUNABLE( CELL_PITCH );
 
   /* All done. */
   return l_position;
 }
 
 
+/*
+ * scan_sheet - counts the invaders left on the sheet, and finds the first and
+ *              last occupied columns, which determine the turn points. The
+ *              count sets the invaders' pace. This only needs doing when the
+ *              sheet changes.
+ */
+
+void GameState::scan_sheet( void )
+{
+  TRACE_ZONE( "GameState::scan_sheet" );
+
+  uint_fast8_t  l_row, l_column;
+
+  PROFILE_BEGIN( PROFILE_SHEET_SCAN );
+  this->m_invader_count = 0;
+  this->m_last_column = 0;
+  this->m_first_column = SHEET_WIDTH;
+
+  for( l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
+  {
+    for( l_column = 0; l_column < SHEET_WIDTH; l_column++ )
+    {
+      /* If it's empty, move on. */
+      if( this->m_invaders[l_row][l_column] == INVADER_NONE )
+      {
+        continue;
+      }
+
+      /* Increase the invader count. */
+      this->m_invader_count++;
+
+      /* If the current column is less that the current first, count it. */
+      if ( this->m_first_column > l_column )
+      {
+        this->m_first_column = l_column;
+      }
+
+      /* Also the last. */
+      if ( this->m_last_column < l_column )
+      {
+        this->m_last_column = l_column;
+      }
+    }
+  }
+
+  /* The fewer there are, the faster they go. */
+  this->m_scheduler.set_period( GAME_TIMER_INVADER,
+                                SCHEDULER_MS( TUNABLE( TEMPO_BASE ) +
+                                              ( this->m_invader_count * TUNABLE( TEMPO_STEP ) ) ) );
+  this->m_sheet_dirty = false;
+  PROFILE_END( PROFILE_SHEET_SCAN );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * save_last - remembers where everything that moves is, before a step moves
+ *             it; drawing goes between there and wherever the step leaves it.
+ */
+
+void GameState::save_last( void )
+{
+  this->m_last_offset = this->m_invader_offset;
+  this->m_last_descent = this->m_invader_descent;
+  this->m_last_base_x = this->m_player_base_loc.x;
+  this->m_last_bullet_y = this->m_player_bullet_loc.y;
+  this->m_last_firing = this->m_player_firing;
+}
+
+
+/*
+ * interpolate - works out where something is between the last step and the
+ *               current one, going by how much of the next step has built up.
+ */
+
+int_fast16_t GameState::interpolate( int_fast16_t p_last, int_fast16_t p_current )
+{
+  int_fast16_t l_step = TUNABLE( SIM_STEP );
+
+  /* Only a change of step size can leave more than a step pending. */
+  if ( this->m_pending_ms >= (uint_fast32_t)l_step )
+  {
+    return p_current;
+  }
+  return p_last + ( ( p_current - p_last ) * (int_fast16_t)this->m_pending_ms ) / l_step;
+}
+
+
+/*
+ * is_moving - returns whether anything is drawn part way between the last two
+ *             steps; if so, it moves on screen every frame, not just every step.
+ */
+
+bool GameState::is_moving( void )
+{
+  return this->m_last_offset != this->m_invader_offset ||
+         this->m_last_descent != this->m_invader_descent ||
+         this->m_last_base_x != this->m_player_base_loc.x ||
+         ( this->m_player_firing && this->m_last_firing &&
+           this->m_last_bullet_y > this->m_player_bullet_loc.y );
+}
+
+
+/*
+ * get_offset_limit - works out how far the invaders can drift in the given
+ *                    direction, before they turn.
+ */
+
+int_fast16_t GameState::get_offset_limit( bool p_ltor )
+{
+  if ( p_ltor )
+  {
+    return SCREEN_WIDTH - ( ( this->m_last_column + 1 ) * TUNABLE( CELL_PITCH ) );
+  }
+  return 0 - ( this->m_first_column * TUNABLE( CELL_PITCH ) );
+}
+
+
 /*
  * update_player - runs all the player updates for a tick; basically check the
  *                 user inputs and issue appropriate commands.
@@ -180,6 +296,11 @@ coord_t GameState::get_invader_position( uint_fast8_t p_x, uint_fast8_t p_y )
 
 void GameState::update_player( void )
 {
+  TRACE_ZONE( "GameState::update_player" );
+
+  uint_fast8_t l_base_x = this->m_player_base_loc.x;
+  bool         l_firing = this->m_player_firing;
+
   /* So, if the user wants to go left (and can), move them. */
   if ( picosystem::button( picosystem::LEFT ) )
   {
@@ -211,6 +332,12 @@ void GameState::update_player( void )
     this->m_player_firing = true;
   }
 
+  /* Anything the player did will need drawing. */
+  if ( this->m_player_base_loc.x != l_base_x || this->m_player_firing != l_firing )
+  {
+    this->m_dirty = true;
+  }
+
   /* All done. */
   return;
 }
@@ -223,6 +350,8 @@ void GameState::update_player( void )
 
 void GameState::update_bullet( void )
 {
+  TRACE_ZONE( "GameState::update_bullet" );
+
   coord_t l_invader_loc, l_sheet_coord;
 
   /* We only have something to do if the player has fired. */
@@ -231,11 +360,16 @@ void GameState::update_bullet( void )
     return;
   }
 
-  /* Then we just move the bullet upwards. */
-  if ( --this->m_player_bullet_loc.y == 0 )
+  /* Then we just move the bullet upwards, until it leaves the screen. */
+  if ( this->m_player_bullet_loc.y <= TUNABLE( BULLET_SPEED ) )
   {
+    this->m_player_bullet_loc.y = 0;
     this->m_player_firing = false;
   }
+  else
+  {
+    this->m_player_bullet_loc.y -= TUNABLE( BULLET_SPEED );
+  }
 
   /* And then do some collision detection. Urgh. Work out what invader is at */
   /* the leading point of the bullet location.                               */
@@ -259,8 +393,12 @@ void GameState::update_bullet( void )
     case INVADER2:
     case INVADER3:
 
+      BINLOG( LOG_KILL, this->m_invaders[l_sheet_coord.y][l_sheet_coord.x],
+              l_sheet_coord.x, l_sheet_coord.y );
+      BINLOG( LOG_SCORE, this->m_score, this->m_score + 10 );
       this->add_explosion( l_invader_loc.x, l_invader_loc.y, SPRITE_BIG_BOOM, true );
       this->m_invaders[l_sheet_coord.y][l_sheet_coord.x] = INVADER_NONE;
+      this->m_sheet_dirty = true;
       this->m_player_firing = false;
       this->m_score += 10;
       break;
@@ -279,10 +417,12 @@ void GameState::update_bullet( void )
 
 void GameState::add_explosion( uint_fast8_t p_x, uint_fast8_t p_y, uint_fast8_t p_sprite, bool p_wide )
 {
+  TRACE_ZONE( "GameState::add_explosion" );
+
   uint_fast8_t l_index;
 
-  /* Run through the array, looking for a gap. */
-  for( l_index = 0; l_index < MAX_EXPLOSIONS; l_index++ )
+  /* Run through the array, looking for a gap; the list can be shortened. */
+  for( l_index = 0; l_index < MAX_EXPLOSIONS && l_index < TUNABLE( EXPLOSION_SLOTS ); l_index++ )
   {
     /* Empty slots are marked with a zero sprite value. */
     if ( this->m_explosion_list[l_index].sprite == 0 )
@@ -308,6 +448,8 @@ void GameState::add_explosion( uint_fast8_t p_x, uint_fast8_t p_y, uint_fast8_t
 
 void GameState::update_explosions( void )
 {
+  TRACE_ZONE( "GameState::update_explosions" );
+
   uint_fast8_t l_index;
 
   /* Run through the array, looking for explosions. */
@@ -317,9 +459,11 @@ void GameState::update_explosions( void )
     {
       case SPRITE_BIG_BOOM:                /* Move on to the next frame. */
         this->m_explosion_list[l_index].sprite = SPRITE_BIG_BOOM_ALT;
+        this->m_dirty = true;
         break;
       case SPRITE_BIG_BOOM_ALT:           /* Final step in the sequence. */
         this->m_explosion_list[l_index].sprite = 0;
+        this->m_dirty = true;
         break;
       default:                                         /* Nothing to do .*/
         break;
@@ -331,60 +475,100 @@ void GameState::update_explosions( void )
 }
 
 /*
- * update_invaders - the invaders drift aimless left and right...
+ * update_invaders - the invaders drift aimless left and right... this moves
+ *                   them on by any number of ticks at once. They can only
+ *                   bounce back and forth between the same two turns, so it's
+ *                   worked out a leg (from one turn to the next) at a time,
+ *                   and once a whole lap has been seen, the rest of the laps
+ *                   are skipped over in one go.
  */
 
-void GameState::update_invaders( int_fast16_t p_offset_limit )
+void GameState::update_invaders( uint_fast32_t p_ticks )
 {
-  uint_fast8_t  l_row, l_column;
+  TRACE_ZONE( "GameState::update_invaders" );
 
-  /* Scan the sheet, and handle any exploding invaders. */
-  for( l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
+  uint_fast8_t  l_row, l_column, l_tick;
+  int_fast16_t  l_left, l_right, l_step, l_moves, l_lap_offset = 0;
+  uint_fast32_t l_lap_ticks = 0, l_laps;
+  uint_fast8_t  l_lap_descent = 0;
+  bool          l_lap_seen = false;
+
+  /* Scan the sheet, and handle any exploding invaders; three ticks is */
+  /* enough for any of them to finish.                                 */
+  for( l_tick = 0; l_tick < p_ticks && l_tick < 3; l_tick++ )
   {
-    for( l_column = 0; l_column < SHEET_WIDTH; l_column++ )
+    for( l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
     {
-      /* If it's exploding, move it through the sequence. */
-      if( this->m_invaders[l_row][l_column] == INVADER_BOOM2 )
-      {
-        this->m_invaders[l_row][l_column] = INVADER_NONE;
-      }
-      if( this->m_invaders[l_row][l_column] == INVADER_BOOM1 )
-      {
-        this->m_invaders[l_row][l_column] = INVADER_BOOM2;
-      }
-      if( this->m_invaders[l_row][l_column] == INVADER_HIT )
+      for( l_column = 0; l_column < SHEET_WIDTH; l_column++ )
       {
-        this->m_invaders[l_row][l_column] = INVADER_BOOM1;
+        /* If it's exploding, move it through the sequence. */
+        if( this->m_invaders[l_row][l_column] == INVADER_BOOM2 )
+        {
+          this->m_invaders[l_row][l_column] = INVADER_NONE;
+        }
+        if( this->m_invaders[l_row][l_column] == INVADER_BOOM1 )
+        {
+          this->m_invaders[l_row][l_column] = INVADER_BOOM2;
+        }
+        if( this->m_invaders[l_row][l_column] == INVADER_HIT )
+        {
+          this->m_invaders[l_row][l_column] = INVADER_BOOM1;
+        }
       }
     }
   }
 
-  /* Move the offset toward the limit, in the appropriate direction. */
-  if ( this->m_invader_ltor )
+  /* The turns don't move while we're doing this. */
+  l_left = this->get_offset_limit( false );
+  l_right = this->get_offset_limit( true );
+  l_step = TUNABLE( INVADER_STEP );
+
+  while( p_ticks > 0 )
   {
-    if ( this->m_invader_offset >= p_offset_limit )
+    /* At the start of each leg to the right, see if it's where the last one */
+    /* started; if so, every lap from here on will be the same as that one.  */
+    if ( this->m_invader_ltor )
     {
-      this->m_invader_ltor = false;
-      this->m_invader_offset -= 2;
-      this->m_invader_descent += 10;
+      if ( l_lap_seen && this->m_invader_offset == l_lap_offset )
+      {
+        l_lap_ticks -= p_ticks;
+        l_laps = p_ticks / l_lap_ticks;
+        p_ticks -= l_laps * l_lap_ticks;
+        this->m_invader_descent += l_laps * (uint_fast8_t)( this->m_invader_descent - l_lap_descent );
+      }
+      l_lap_seen = true;
+      l_lap_offset = this->m_invader_offset;
+      l_lap_ticks = p_ticks;
+      l_lap_descent = this->m_invader_descent;
     }
-    else
+
+    /* Work out how many steps there are before the turn. */
+    if ( this->m_invader_ltor )
     {
-      this->m_invader_offset += 2;
+      l_moves = this->m_invader_offset < l_right ?
+                ( l_right - this->m_invader_offset + l_step - 1 ) / l_step : 0;
     }
-  }
-  else
-  {
-    if ( this->m_invader_offset <= p_offset_limit )
+    else
     {
-      this->m_invader_ltor = true;
-      this->m_invader_offset += 2;
-      this->m_invader_descent += 10;
+      l_moves = this->m_invader_offset > l_left ?
+                ( this->m_invader_offset - l_left + l_step - 1 ) / l_step : 0;
     }
-    else
+
+    /* If we run out of ticks before then, that's as far as they get. */
+    if ( p_ticks <= (uint_fast32_t)l_moves )
     {
-      this->m_invader_offset -= 2;
+      l_moves = p_ticks;
+      this->m_invader_offset += this->m_invader_ltor ? l_moves * l_step : 0 - l_moves * l_step;
+      break;
     }
+
+    /* Otherwise, all the way to the turn; the turn itself takes a tick, */
+    /* stepping back the other way and dropping down.                    */
+    l_moves--;
+    this->m_invader_offset += this->m_invader_ltor ? l_moves * l_step : 0 - l_moves * l_step;
+    this->m_invader_ltor = !this->m_invader_ltor;
+    this->m_invader_descent += TUNABLE( INVADER_DROP );
+    p_ticks -= l_moves + 2;
   }
 
   /* All done. */
@@ -393,17 +577,19 @@ void GameState::update_invaders( int_fast16_t p_offset_limit )
 
 /*
  * update - called every frame to update the state; passed a delta indicating
- *          the ms since the last time we were called, and can be used for
- *          pacing.
+ *          the ms since the last time we were called. The simulation itself
+ *          runs in fixed steps, so the delta just sets how many of them are
+ *          due; whatever's left over carries on to the next frame.
  * Returns the gamestate we should end up in; usually this is ourselves, but
  * allows this state to determine if/when we change to another.
  */
 
 gamestate_t GameState::update( uint32_t p_delta )
 {
-  uint_fast8_t  l_first_column, l_last_column, l_invader_count;
-  uint_fast8_t  l_row, l_column;
-  int_fast16_t  l_offset_limit;
+  TRACE_ZONE( "GameState::update" );
+
+  uint_fast8_t  l_timer, l_index;
+  uint_fast32_t l_step;
 
   /* Keep track of the passage of time. Note that the first delta may be */
   /* unnaturally large, so we need to dispense with it quietly.          */
@@ -413,84 +599,105 @@ gamestate_t GameState::update( uint32_t p_delta )
   }
   else
   {
-    /* Update our internal time count. */
-    this->m_time_ms += p_delta;
-
-    /* And also our tickers. */
-    this->m_invader_tick->add_delta( p_delta );
-    this->m_base_tick->add_delta( p_delta );
-    this->m_bullet_tick->add_delta( p_delta );
-    this->m_explosion_tick->add_delta( p_delta );
+    this->m_pending_ms += p_delta;
   }
 
-  /* Update any active explosions; we do this first, so any new explosions */
-  /* triggered in this tick don't get immediately updated.                 */
-  while( this->m_explosion_tick->ticked() )
+  /* The timers count their firings afresh every frame. */
+  this->m_scheduler.reset_counts();
+
+  /* When the tunables can change under us, pick up any new periods. */
+#ifdef PICOVADERS_TUNABLES
+  this->m_scheduler.set_period( GAME_TIMER_BASE, SCHEDULER_MS( TUNABLE( BASE_PERIOD ) ) );
+  this->m_scheduler.set_period( GAME_TIMER_BULLET, SCHEDULER_MS( TUNABLE( BULLET_PERIOD ) ) );
+  this->m_scheduler.set_period( GAME_TIMER_EXPLOSION, SCHEDULER_MS( TUNABLE( EXPLOSION_PERIOD ) ) );
+  this->m_scheduler.set_catchup_limit( TUNABLE( CATCHUP_LIMIT ) );
+  this->m_scheduler.set_period( GAME_TIMER_INVADER,
+                                SCHEDULER_MS( TUNABLE( TEMPO_BASE ) +
+                                              ( this->m_invader_count * TUNABLE( TEMPO_STEP ) ) ) );
+#endif
+
+  /* The invader count sets their pace, so make sure it's current. */
+  if ( this->m_sheet_dirty )
   {
-    this->update_explosions();
+    this->scan_sheet();
   }
 
-  /* Next order of the day, move any bullets and bombs in flight. */
-  while( this->m_bullet_tick->ticked() )
+  /* Run as many whole steps as are due; if we've fallen too far behind to */
+  /* catch up, the excess is dropped, rather than taking ever longer.      */
+  l_step = TUNABLE( SIM_STEP );
+  for ( this->m_steps = 0; this->m_pending_ms >= l_step; this->m_steps++ )
   {
-    this->update_bullet();
-  }
+    if ( this->m_steps >= TUNABLE( SIM_MAX_STEPS ) )
+    {
+      this->m_dropped_ms += this->m_pending_ms - ( this->m_pending_ms % l_step );
+      this->m_pending_ms %= l_step;
+      break;
+    }
 
-  /* Scan the sheet, to work out both how many invaders remain, and the  */
-  /* first and last occupied columns, which determines turn points.      */
-  l_invader_count = 0;
-  l_last_column = 0;
-  l_first_column = SHEET_WIDTH;
+    /* Remember where things were, and move time on by a step. */
+    this->save_last();
+    this->m_pending_ms -= l_step;
+    this->m_time_ms += l_step;
+    this->m_scheduler.advance( SCHEDULER_MS( l_step ) );
 
-  for( l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
-  {
-    for( l_column = 0; l_column < SHEET_WIDTH; l_column++ )
+    /* Now work through whatever fell due, in the order it did so. */
+    while( ( l_timer = this->m_scheduler.next() ) != SCHEDULER_NONE )
     {
-      /* If it's empty, move on. */
-      if( this->m_invaders[l_row][l_column] == INVADER_NONE )
+      switch( l_timer )
       {
-        continue;
-      }
+        case GAME_TIMER_EXPLOSION:       /* Move any explosions on a frame. */
+          PROFILE_BEGIN( PROFILE_EXPLOSIONS );
+          this->update_explosions();
+          PROFILE_END( PROFILE_EXPLOSIONS );
+          break;
 
-      /* Increase the invader count. */
-      l_invader_count++;
+        case GAME_TIMER_BULLET:          /* Move the bullet, maybe hitting. */
+          if ( this->m_player_firing )
+          {
+            this->m_dirty = true;
+          }
+          PROFILE_BEGIN( PROFILE_BULLET );
+          this->update_bullet();
+          PROFILE_END( PROFILE_BULLET );
+          if ( this->m_sheet_dirty )
+          {
+            this->scan_sheet();
+          }
+          break;
 
-      /* If the current column is less that the current first, count it. */
-      if ( l_first_column > l_column )
-      {
-        l_first_column = l_column;
-      }
+        case GAME_TIMER_INVADER:         /* Drift the invaders along.       */
+          this->m_dirty = true;
+          PROFILE_BEGIN( PROFILE_INVADERS );
+          this->update_invaders( 1 + this->m_scheduler.take_run( GAME_TIMER_INVADER ) );
+          PROFILE_END( PROFILE_INVADERS );
+          break;
 
-      /* Also the last. */
-      if ( l_last_column < l_column )
-      {
-        l_last_column = l_column;
+        case GAME_TIMER_BASE:            /* Handle the player.              */
+          PROFILE_BEGIN( PROFILE_PLAYER );
+          this->update_player();
+          PROFILE_END( PROFILE_PLAYER );
+          break;
       }
     }
   }
 
-  /* And now we can derive the tick rate and limits from this, and move them. */
-  this->m_invader_tick->set_frequency( 10 + (l_invader_count*7) );
-  if ( this->m_invader_ltor )
-  {
-    l_offset_limit = 220 - ( l_last_column * 20 );
-  }
-  else
-  {
-    l_offset_limit = 0 - ( l_first_column * 20 );
-  }
-
-  /* The invaders will drift left and right, as a fairly leisurely pace. */
-  while( this->m_invader_tick->ticked() )
+  /* Anything drawn between steps moves whenever time does. */
+  if ( p_delta > 0 && this->is_moving() )
   {
-    this->update_invaders( l_offset_limit );
+    this->m_dirty = true;
   }
 
-  /* Handle the player. */
-  while( this->m_base_tick->ticked() )
+  /* Let the flight recorder know how much work that was, and how busy we are. */
+  flight_set_ticks( FLIGHT_TICK_EXPLOSION, this->m_scheduler.get_fired( GAME_TIMER_EXPLOSION ) );
+  flight_set_ticks( FLIGHT_TICK_BULLET, this->m_scheduler.get_fired( GAME_TIMER_BULLET ) );
+  flight_set_ticks( FLIGHT_TICK_INVADER, this->m_scheduler.get_fired( GAME_TIMER_INVADER ) );
+  flight_set_ticks( FLIGHT_TICK_BASE, this->m_scheduler.get_fired( GAME_TIMER_BASE ) );
+  l_index = 0;
+  for ( const explosion_t &l_explosion : this->m_explosion_list )
   {
-    this->update_player();
+    l_index += ( l_explosion.sprite != 0 );
   }
+  flight_set_counts( l_index, this->m_invader_count );
 
   /* By default, stay in this state. */
   return this->m_state;
@@ -503,21 +710,26 @@ gamestate_t GameState::update( uint32_t p_delta )
 
 void GameState::draw( void )
 {
+  TRACE_ZONE( "GameState::draw" );
+
   int32_t       l_width, l_height;
   uint8_t       l_alpha;
   uint32_t      l_invader1, l_invader2, l_invader3;
   uint_fast8_t  l_row, l_column, l_index;
+  int32_t       l_offset, l_descent;
   int32_t       l_invader_x, l_invader_y;
-  coord_t       l_invader_loc;
+  int32_t       l_base_x, l_bullet_y;
   int32_t       l_bullet;
   char          l_buffer[32];
 
   /* Clear the screen every time... */
+  PROFILE_BEGIN( PROFILE_DRAW_CLEAR );
   picosystem::pen( 0, 0, 0 );
   picosystem::clear();
+  PROFILE_END( PROFILE_DRAW_CLEAR );
 
   /* Select the right animation frames, based on the relevant tick. */
-  if ( this->m_invader_tick->get_count() % 2 )
+  if ( this->m_scheduler.get_count( GAME_TIMER_INVADER ) % 2 )
   {
     l_invader1 = SPRITE_INVADER1;
     l_invader2 = SPRITE_INVADER2;
@@ -529,7 +741,7 @@ void GameState::draw( void )
     l_invader2 = SPRITE_INVADER2_ALT;
     l_invader3 = SPRITE_INVADER3_ALT;
   }
-  if ( this->m_bullet_tick->get_count() % 2 )
+  if ( this->m_scheduler.get_count( GAME_TIMER_BULLET ) % 2 )
   {
     l_bullet = SPRITE_BULLET;
   }
@@ -538,49 +750,64 @@ void GameState::draw( void )
     l_bullet = SPRITE_BULLET_ALT;
   }
 
+  /* Everything that moves is drawn part way between the last two steps. */
+  l_offset = this->interpolate( this->m_last_offset, this->m_invader_offset );
+  l_descent = this->interpolate( this->m_last_descent, this->m_invader_descent );
+  l_base_x = this->interpolate( this->m_last_base_x, this->m_player_base_loc.x );
+  l_bullet_y = this->m_player_bullet_loc.y;
+  if ( this->m_last_firing && this->m_last_bullet_y >= l_bullet_y )
+  {
+    /* Unless it's only just been fired, that is. */
+    l_bullet_y = this->interpolate( this->m_last_bullet_y, l_bullet_y );
+  }
+
   /* Draw some ... invaders! */
+  PROFILE_BEGIN( PROFILE_DRAW_SHEET );
   for( l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
   {
     for( l_column = 0; l_column < SHEET_WIDTH; l_column++ )
     {
-      /* Work out the co-ordinates. */
-      l_invader_loc = this->get_invader_location( l_column, l_row );
+      /* Work out the co-ordinates; as get_invader_location(), but between steps. */
+      l_invader_x = ( l_column * TUNABLE( CELL_PITCH ) ) + l_offset;
+      l_invader_y = ( l_row * TUNABLE( CELL_PITCH ) ) + l_descent;
 
       /* And render the right thing. */
       switch( this->m_invaders[l_row][l_column] )
       {
         case INVADER1:
-          picosystem::sprite( l_invader1, l_invader_loc.x, l_invader_loc.y );
-          picosystem::sprite( l_invader1+1, l_invader_loc.x+8, l_invader_loc.y );
+          picosystem::sprite( l_invader1, l_invader_x, l_invader_y );
+          picosystem::sprite( l_invader1+1, l_invader_x+8, l_invader_y );
           break;
         case INVADER2:
-          picosystem::sprite( l_invader2, l_invader_loc.x, l_invader_loc.y );
-          picosystem::sprite( l_invader2+1, l_invader_loc.x+8, l_invader_loc.y );
+          picosystem::sprite( l_invader2, l_invader_x, l_invader_y );
+          picosystem::sprite( l_invader2+1, l_invader_x+8, l_invader_y );
           break;
         case INVADER3:
-          picosystem::sprite( l_invader3, l_invader_loc.x, l_invader_loc.y );
-          picosystem::sprite( l_invader3+1, l_invader_loc.x+8, l_invader_loc.y );
+          picosystem::sprite( l_invader3, l_invader_x, l_invader_y );
+          picosystem::sprite( l_invader3+1, l_invader_x+8, l_invader_y );
           break;
         case INVADER_BOOM1:
-          picosystem::sprite( SPRITE_BIG_BOOM, l_invader_loc.x, l_invader_loc.y );
-          picosystem::sprite( SPRITE_BIG_BOOM+1, l_invader_loc.x+8, l_invader_loc.y );
+          picosystem::sprite( SPRITE_BIG_BOOM, l_invader_x, l_invader_y );
+          picosystem::sprite( SPRITE_BIG_BOOM+1, l_invader_x+8, l_invader_y );
           break;
         case INVADER_BOOM2:
-          picosystem::sprite( SPRITE_BIG_BOOM_ALT, l_invader_loc.x, l_invader_loc.y );
-          picosystem::sprite( SPRITE_BIG_BOOM_ALT+1, l_invader_loc.x+8, l_invader_loc.y );
+          picosystem::sprite( SPRITE_BIG_BOOM_ALT, l_invader_x, l_invader_y );
+          picosystem::sprite( SPRITE_BIG_BOOM_ALT+1, l_invader_x+8, l_invader_y );
           break;
       }
     }
   }
+  PROFILE_END( PROFILE_DRAW_SHEET );
 
   /* Also, draw the player. */
-  picosystem::sprite( SPRITE_BASE, this->m_player_base_loc.x, m_player_base_loc.y );
-  picosystem::sprite( SPRITE_BASE+1, this->m_player_base_loc.x+8, m_player_base_loc.y );
+  PROFILE_BEGIN( PROFILE_DRAW_SPRITES );
+  picosystem::sprite( SPRITE_BASE, l_base_x, m_player_base_loc.y );
+  picosystem::sprite( SPRITE_BASE+1, l_base_x+8, m_player_base_loc.y );
 
   /* Player bullet, if there is one. */
   if ( this->m_player_firing )
   {
-    picosystem::sprite( l_bullet, this->m_player_bullet_loc.x, this->m_player_bullet_loc.y );
+    picosystem::sprite( l_bullet, this->m_player_bullet_loc.x, l_bullet_y );
   }
 
   /* And any explosions. */
@@ -604,13 +831,110 @@ void GameState::draw( void )
     }
   }
 
+  PROFILE_END( PROFILE_DRAW_SPRITES );
+
   /* Lastly, draw the score line at the top of the screen. */
+  PROFILE_BEGIN( PROFILE_DRAW_TEXT );
   picosystem::pen( 15, 15, 15 );
   snprintf( l_buffer, 30, "SCORE: %06d", this->m_score );
   picosystem::measure( l_buffer, l_width, l_height );
   picosystem::text( l_buffer, SCREEN_WIDTH - l_width - 20, 0 );
   snprintf( l_buffer, 30, "HI: %06d", 0 );
   picosystem::text( l_buffer, 20, 0 );
+  PROFILE_END( PROFILE_DRAW_TEXT );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * get_idle_us - returns how long it'll be before anything on screen changes;
+ *               that's the step on which the next timer falls due, as the
+ *               simulation only moves a whole step at a time.
+ */
+
+uint32_t GameState::get_idle_us( void )
+{
+  uint32_t l_step_us, l_due_us, l_steps;
+
+  /* Anything between steps is redrawn every frame. */
+  if ( this->is_moving() )
+  {
+    return 0;
+  }
+
+  l_step_us = SCHEDULER_MS( TUNABLE( SIM_STEP ) );
+  l_due_us = this->m_scheduler.get_time_to_next();
+  l_steps = ( l_due_us + l_step_us - 1 ) / l_step_us;
+  if ( l_steps * l_step_us <= SCHEDULER_MS( this->m_pending_ms ) )
+  {
+    return 0;
+  }
+  return l_steps * l_step_us - SCHEDULER_MS( this->m_pending_ms );
+}
+
+
+/*
+ * describe - writes out our internals, for the debug console.
+ */
+
+void GameState::describe( FILE *p_stream )
+{
+  uint_fast8_t  l_row, l_column, l_index;
+  uint_fast8_t  l_explosions = 0;
+
+  fprintf( p_stream, "game: %lums, score %lu\n",
+           (unsigned long)this->m_time_ms, (unsigned long)this->m_score );
+  fprintf( p_stream, "  invaders: offset %d, descent %u, moving %s\n",
+           (int)this->m_invader_offset, (unsigned)this->m_invader_descent,
+           this->m_invader_ltor ? "right" : "left" );
+
+  /* The sheet, one row per line; '.' is empty, digits are invader types. */
+  for ( l_row = 0; l_row < SHEET_HEIGHT; l_row++ )
+  {
+    fprintf( p_stream, "  sheet %u: ", (unsigned)l_row );
+    for ( l_column = 0; l_column < SHEET_WIDTH; l_column++ )
+    {
+      uint_fast8_t l_invader = this->m_invaders[l_row][l_column];
+      fputc( l_invader == INVADER_NONE ? '.' : '0' + l_invader, p_stream );
+    }
+    fputc( '\n', p_stream );
+  }
+
+  /* The player and their bullet. */
+  fprintf( p_stream, "  player: x %u, firing %s", (unsigned)this->m_player_base_loc.x,
+           this->m_player_firing ? "yes" : "no" );
+  if ( this->m_player_firing )
+  {
+    fprintf( p_stream, " (bullet %u,%u)", (unsigned)this->m_player_bullet_loc.x,
+             (unsigned)this->m_player_bullet_loc.y );
+  }
+  fputc( '\n', p_stream );
+
+  /* Explosions in flight. */
+  for ( l_index = 0; l_index < MAX_EXPLOSIONS; l_index++ )
+  {
+    l_explosions += ( this->m_explosion_list[l_index].sprite != 0 );
+  }
+  fprintf( p_stream, "  explosions: %u of %u\n", (unsigned)l_explosions, MAX_EXPLOSIONS );
+
+  /* And the tickers. */
+  fprintf( p_stream, "  timers: invader %luus/%lu, base %luus/%lu, bullet %luus/%lu, explosion %luus/%lu\n",
+           (unsigned long)this->m_scheduler.get_period( GAME_TIMER_INVADER ),
+           (unsigned long)this->m_scheduler.get_count( GAME_TIMER_INVADER ),
+           (unsigned long)this->m_scheduler.get_period( GAME_TIMER_BASE ),
+           (unsigned long)this->m_scheduler.get_count( GAME_TIMER_BASE ),
+           (unsigned long)this->m_scheduler.get_period( GAME_TIMER_BULLET ),
+           (unsigned long)this->m_scheduler.get_count( GAME_TIMER_BULLET ),
+           (unsigned long)this->m_scheduler.get_period( GAME_TIMER_EXPLOSION ),
+           (unsigned long)this->m_scheduler.get_count( GAME_TIMER_EXPLOSION ) );
+  fprintf( p_stream, "  last update: %u steps of %ldms, %lu catch-up firings, %lu skipped\n",
+           (unsigned)this->m_steps, (long)TUNABLE( SIM_STEP ),
+           (unsigned long)this->m_scheduler.get_catchup(),
+           (unsigned long)this->m_scheduler.get_skipped() );
+  fprintf( p_stream, "  pending: %lums, %lums dropped in all\n",
+           (unsigned long)this->m_pending_ms, (unsigned long)this->m_dropped_ms );
 
   /* All done. */
   return;
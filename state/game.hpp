@@ -11,7 +11,7 @@
 
 #pragma once
 
-#include "utils/tick.hpp"
+#include "utils/scheduler.hpp"
 
 #define SHEET_WIDTH   10
 #define SHEET_HEIGHT  5
@@ -28,18 +28,41 @@ struct explosion_t
 
 #define MAX_EXPLOSIONS 15
 
+/* The timers, in the order they're added to the scheduler. */
+typedef enum
+{
+  GAME_TIMER_EXPLOSION,
+  GAME_TIMER_BULLET,
+  GAME_TIMER_INVADER,
+  GAME_TIMER_BASE,
+  GAME_TIMER_MAX
+} gametimer_t;
+
 class GameState : public GameStateInterface
 {
+friend class StateProbe;
+
 private:
   uint_fast32_t   m_time_ms;
   int_fast16_t    m_invader_offset;
   uint_fast8_t    m_invader_descent;
   bool            m_invader_ltor;
   uint_fast8_t    m_invaders[SHEET_HEIGHT][SHEET_WIDTH];
-  TickCounter    *m_invader_tick;
-  TickCounter    *m_base_tick;
-  TickCounter    *m_bullet_tick;
-  TickCounter    *m_explosion_tick;
+  bool            m_sheet_dirty;
+  uint_fast8_t    m_invader_count;
+  uint_fast8_t    m_first_column;
+  uint_fast8_t    m_last_column;
+  TickScheduler   m_scheduler;
+  uint_fast32_t   m_pending_ms;
+  uint_fast32_t   m_dropped_ms;
+  uint_fast8_t    m_steps;
+
+  /* Where things were before the last step, for drawing between the two. */
+  int_fast16_t    m_last_offset;
+  uint_fast8_t    m_last_descent;
+  uint_fast8_t    m_last_base_x;
+  uint_fast8_t    m_last_bullet_y;
+  bool            m_last_firing;
 
   explosion_t     m_explosion_list[MAX_EXPLOSIONS+1];
 
@@ -49,6 +72,11 @@ private:
   uint32_t        m_score;
 
   void            load_level( void );
+  void            scan_sheet( void );
+  void            save_last( void );
+  int_fast16_t    interpolate( int_fast16_t, int_fast16_t );
+  bool            is_moving( void );
+  int_fast16_t    get_offset_limit( bool );
   coord_t         get_invader_location( uint_fast8_t, uint_fast8_t );
   coord_t         get_invader_position( uint_fast8_t, uint_fast8_t );
 
@@ -56,7 +84,7 @@ private:
   void            update_bullet( void );
   void            add_explosion( uint_fast8_t, uint_fast8_t, uint_fast8_t, bool );
   void            update_explosions( void );
-  void            update_invaders( int_fast16_t );
+  void            update_invaders( uint_fast32_t );
 
 public:
                   GameState( void );
@@ -64,6 +92,8 @@ public:
 
   gamestate_t     update( uint32_t );
   void            draw( void );
+  void            describe( FILE * );
+  uint32_t        get_idle_us( void );
 };
 
 
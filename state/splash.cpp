@@ -20,6 +20,8 @@
 #include "picovaders.hpp"
 #include "state/splash.hpp"
 #include "assets/logo_ahnlak_1bit.hpp"
+#include "utils/trace.hpp"
+#include "utils/xip.hpp"
 
 
 /* Functions. */
@@ -36,6 +38,9 @@ SplashState::SplashState( void )
   /* And set the timer to zero. */
   this->m_time_ms = 0;
 
+  /* The logo is read straight out of flash. */
+  XIP_REGION( logo_ahnlak_1bit_data, sizeof( logo_ahnlak_1bit_data ), "logo" );
+
   /* All done. */
   return;
 }
@@ -62,6 +67,8 @@ SplashState::~SplashState()
 
 gamestate_t SplashState::update( uint32_t p_delta )
 {
+  TRACE_ZONE( "SplashState::update" );
+
   /* Keep track of the passage of time. Note that the first delta may be */
   /* unnaturally large, so we need to dispense with it quietly.          */
 #if 0
@@ -75,6 +82,9 @@ gamestate_t SplashState::update( uint32_t p_delta )
     this->m_time_ms += p_delta;
   }
 
+  /* The fade and the colour cycle move on every frame. */
+  this->m_dirty = true;
+
   /* If we've splashed for 2 seconds, we can move on. */
   if ( this->m_time_ms > 2000 )
   {
@@ -92,6 +102,8 @@ gamestate_t SplashState::update( uint32_t p_delta )
 
 void SplashState::draw( void )
 {
+  TRACE_ZONE( "SplashState::draw" );
+
   uint8_t l_alpha = 0, l_green;
 
   /* Clear the screen every time... */
@@ -122,7 +134,8 @@ void SplashState::draw( void )
 
     picosystem::pen( 15, l_green, 15, l_alpha );
 
-    /* And draw the line data. */
+    /* And draw the line data; a row of bits at a time. */
+    XIP_READ( l_logo, ( 216 - 24 ) / 8 );
     for ( uint_fast8_t x = 24; x < 216; x += 8 )
     {
       for ( uint_fast8_t bit = 0; bit < 8; bit++ )
@@ -141,4 +154,15 @@ void SplashState::draw( void )
 }
 
 
+/*
+ * describe - writes out our internals, for the debug console.
+ */
+
+void SplashState::describe( FILE *p_stream )
+{
+  fprintf( p_stream, "splash: %lums\n", (unsigned long)this->m_time_ms );
+  return;
+}
+
+
 /* End of file state/splash.cpp */
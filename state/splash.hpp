@@ -13,6 +13,8 @@
 
 class SplashState : public GameStateInterface
 {
+friend class StateProbe;
+
 private:
   uint_fast16_t   m_time_ms;
 
@@ -22,6 +24,7 @@ public:
 
   gamestate_t     update( uint32_t );
   void            draw( void );
+  void            describe( FILE * );
 };
 
 
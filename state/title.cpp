@@ -14,6 +14,9 @@
 
 /* System headers. */
 
+#include <algorithm>
+
+
 /* Local headers. */
 
 #include "picosystem.hpp"
@@ -21,16 +24,17 @@
 #include "assets/spritesheet.hpp"
 #include "state/title.hpp"
 #include "utils/text.hpp"
-#include "utils/tick.hpp"
+#include "utils/trace.hpp"
 
 
 /* Functions. */
 
 /*
- * constructor - just initialises things like timers and assets.
+ * constructor - just initialises things like timers and assets; anything we
+ *               need to allocate comes from our own arena.
  */
 
-TitleState::TitleState( void )
+TitleState::TitleState( void ) : m_arena( m_arena_storage, sizeof( m_arena_storage ) )
 {
   /* Remember what state we are! */
   this->m_state = GAMESTATE_TITLE;
@@ -38,15 +42,15 @@ TitleState::TitleState( void )
   /* And set the timer to zero. */
   this->m_time_ms = 0;
 
-  /* Intialise the various tickers. */
-  this->m_invader_tick = new TickCounter( 300 );
+  /* Intialise the invaders' timer. */
+  this->m_invader_timer = this->m_scheduler.add( SCHEDULER_MS( 300 ) );
 
   /* And the invader offset (we'll let them drift left and right) */
   this->m_invader_offset = 20;
   this->m_invader_ltor = true;
 
   /* Create the prompt text. */
-  this->m_prompt = new ScalableText( "PRESS X TO START", 1.5f );
+  this->m_prompt = this->m_arena.make<ScalableText>( "PRESS X TO START", 1.5f, &this->m_arena );
 
   /* All done. */
   return;
@@ -54,25 +58,12 @@ TitleState::TitleState( void )
 
 
 /*
- * destructor - tidy up any allocated resources.
+ * destructor - tidy up any allocated resources; everything is in the arena,
+ *              which goes with us.
  */
 
 TitleState::~TitleState()
 {
-  /* Clean up the tickers. */
-  if ( this->m_invader_tick != nullptr )
-  {
-    delete this->m_invader_tick;
-    this->m_invader_tick = nullptr;
-  }
-
-  /* Clean up the prompt, if it was assigned. */
-  if ( this->m_prompt != nullptr )
-  {
-    delete this->m_prompt;
-    this->m_prompt = nullptr;
-  }
-
   /* All done. */
   return;
 }
@@ -88,6 +79,10 @@ TitleState::~TitleState()
 
 gamestate_t TitleState::update( uint32_t p_delta )
 {
+  TRACE_ZONE( "TitleState::update" );
+
+  uint_fast32_t l_prompt_step = this->m_time_ms / TITLE_PROMPT_STEP_MS;
+
   /* Keep track of the passage of time. Note that the first delta may be */
   /* unnaturally large, so we need to dispense with it quietly.          */
   if ( this->m_time_ms == 0 )
@@ -98,13 +93,17 @@ gamestate_t TitleState::update( uint32_t p_delta )
   {
     this->m_time_ms += p_delta;
 
-    /* And also our tickers. */
-    this->m_invader_tick->add_delta( p_delta );
+    /* And also our timer. */
+    this->m_scheduler.advance( SCHEDULER_MS( p_delta ) );
   }
 
   /* The invaders will drift left and right, as a fairly leisurely pace. */
-  while( this->m_invader_tick->ticked() )
+  this->m_scheduler.reset_counts();
+  while( this->m_scheduler.next() != SCHEDULER_NONE )
   {
+    /* Every move changes the invaders' frame, as well as where they are. */
+    this->m_dirty = true;
+
     /* And move the offset. */
     if ( this->m_invader_ltor )
     {
@@ -132,6 +131,12 @@ gamestate_t TitleState::update( uint32_t p_delta )
     }
   }
 
+  /* The prompt only needs redrawing when it changes brightness. */
+  if ( this->m_time_ms / TITLE_PROMPT_STEP_MS != l_prompt_step )
+  {
+    this->m_dirty = true;
+  }
+
   /* Check to see if the player has pressed X, in order to start the game. */
   if ( picosystem::pressed( picosystem::X ) )
   {
@@ -149,6 +154,8 @@ gamestate_t TitleState::update( uint32_t p_delta )
 
 void TitleState::draw( void )
 {
+  TRACE_ZONE( "TitleState::draw" );
+
   int32_t   l_width, l_height;
   uint32_t  l_invader1, l_invader2;
   uint8_t   l_alpha;
@@ -164,7 +171,7 @@ void TitleState::draw( void )
                     (SCREEN_HEIGHT - SPRITE_TITLE_H) / 2 );
 
   /* Draw some ... invaders! */
-  if ( this->m_invader_tick->get_count() % 2 )
+  if ( this->m_scheduler.get_count( this->m_invader_timer ) % 2 )
   {
     l_invader1 = SPRITE_INVADER1;
     l_invader2 = SPRITE_INVADER2;
@@ -184,7 +191,7 @@ void TitleState::draw( void )
   }
 
   /* And prompt the player to start. */
-  l_alpha = 5 + abs(((this->m_time_ms/50)%20)-10);
+  l_alpha = 5 + abs(((this->m_time_ms/TITLE_PROMPT_STEP_MS)%20)-10);
   picosystem::pen( 10, 15, 15, l_alpha );
   this->m_prompt->draw( ( SCREEN_WIDTH - this->m_prompt->get_width() ) / 2, 180 );
 
@@ -199,4 +206,34 @@ void TitleState::draw( void )
 }
 
 
+/*
+ * describe - writes out our internals, for the debug console.
+ */
+
+void TitleState::describe( FILE *p_stream )
+{
+  fprintf( p_stream, "title: %lums, invader offset %u, moving %s\n",
+           (unsigned long)this->m_time_ms, (unsigned)this->m_invader_offset,
+           this->m_invader_ltor ? "right" : "left" );
+  fprintf( p_stream, "  timers: invader %luus/%lu\n",
+           (unsigned long)this->m_scheduler.get_period( this->m_invader_timer ),
+           (unsigned long)this->m_scheduler.get_count( this->m_invader_timer ) );
+  fprintf( p_stream, "  arena: %lu of %lu bytes\n", (unsigned long)this->m_arena.get_used(),
+           (unsigned long)this->m_arena.get_size() );
+  return;
+}
+
+
+/*
+ * get_idle_us - returns how long it'll be before anything on screen changes;
+ *               either the invaders move, or the prompt changes brightness.
+ */
+
+uint32_t TitleState::get_idle_us( void )
+{
+  return std::min( this->m_scheduler.get_time_to_next(),
+                   SCHEDULER_MS( TITLE_PROMPT_STEP_MS - this->m_time_ms % TITLE_PROMPT_STEP_MS ) );
+}
+
+
 /* End of file state/title.cpp */
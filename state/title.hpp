@@ -11,18 +11,30 @@
 
 #pragma once
 
+#include "utils/arena.hpp"
+#include "utils/scheduler.hpp"
 #include "utils/text.hpp"
-#include "utils/tick.hpp"
+
+/* Enough for the prompt text, along with its buffer. */
+#define TITLE_ARENA_SIZE  4096
+
+/* The prompt pulses, one step in brightness at a time. */
+#define TITLE_PROMPT_STEP_MS  50
 
 class TitleState : public GameStateInterface
 {
+friend class StateProbe;
+
 private:
   uint_fast32_t   m_time_ms;
   uint_fast8_t    m_invader_offset;
   bool            m_invader_ltor;
   ScalableText   *m_prompt = nullptr;
-  TickCounter    *m_invader_tick;
+  TickScheduler   m_scheduler;
+  uint_fast8_t    m_invader_timer;
 
+  alignas( std::max_align_t ) uint8_t m_arena_storage[TITLE_ARENA_SIZE];
+  Arena           m_arena;
 
 public:
                   TitleState( void );
@@ -30,6 +42,8 @@ public:
 
   gamestate_t     update( uint32_t );
   void            draw( void );
+  void            describe( FILE * );
+  uint32_t        get_idle_us( void );
 };
 
 
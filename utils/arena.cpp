@@ -0,0 +1,109 @@
+/*
+ * utils/arena.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file implements the Arena class; a simple bump allocator over a fixed
+ * block of memory, which each state uses for its tickers, text buffers and
+ * anything else it needs for as long as it exists. Nothing is ever freed on
+ * its own; the whole arena is simply dropped when the state is.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/arena.hpp"
+
+
+/* Functions. */
+
+/*
+ * constructor - takes over the block of memory we'll be handing out; it's
+ *               owned by the caller, and must outlive us.
+ */
+
+Arena::Arena( void *p_base, uint32_t p_size )
+{
+  this->m_base = (uint8_t *)p_base;
+  this->m_size = p_size;
+  this->m_used = 0;
+  this->m_failed = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * destructor - nothing to do; the memory was never ours to free.
+ */
+
+Arena::~Arena()
+{
+  /* All done. */
+  return;
+}
+
+
+/*
+ * alloc - hands out the next suitably aligned chunk of the arena; returns
+ *         nullptr (and counts the failure) if there isn't room.
+ */
+
+void *Arena::alloc( uint32_t p_size, uint32_t p_align )
+{
+  uintptr_t l_start;
+
+  /* Align the start of the chunk, relative to the real address. */
+  l_start = (uintptr_t)( this->m_base + this->m_used );
+  l_start = ( l_start + p_align - 1 ) & ~(uintptr_t)( p_align - 1 );
+
+  /* Make sure it fits. */
+  if ( l_start + p_size > (uintptr_t)( this->m_base + this->m_size ) )
+  {
+    this->m_failed++;
+    return nullptr;
+  }
+
+  /* And move on past it. */
+  this->m_used = ( l_start + p_size ) - (uintptr_t)this->m_base;
+  return (void *)l_start;
+}
+
+
+/*
+ * reset - empties the arena in one go; anything allocated from it is gone.
+ */
+
+void Arena::reset( void )
+{
+  this->m_used = 0;
+  return;
+}
+
+
+/*
+ * get_used, get_size and get_failed - report how full the arena is, and how
+ *                                     many allocations it couldn't fit.
+ */
+
+uint32_t Arena::get_used( void )
+{
+  return this->m_used;
+}
+uint32_t Arena::get_size( void )
+{
+  return this->m_size;
+}
+uint32_t Arena::get_failed( void )
+{
+  return this->m_failed;
+}
+
+
+/* End of file utils/arena.cpp */
@@ -0,0 +1,58 @@
+/*
+ * utils/arena.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file defines the Arena class; a simple bump allocator over a fixed
+ * block of memory, which each state uses for its tickers, text buffers and
+ * anything else it needs for as long as it exists. Nothing is ever freed on
+ * its own; the whole arena is simply dropped when the state is.
+ *
+ * That does mean that destructors are never run, so only objects that don't
+ * need them (or which know they live in an arena) belong here.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+/* System headers. */
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+class Arena
+{
+private:
+  uint8_t    *m_base;
+  uint32_t    m_size;
+  uint32_t    m_used;
+  uint32_t    m_failed;
+
+public:
+              Arena( void *, uint32_t );
+             ~Arena();
+
+  void       *alloc( uint32_t, uint32_t = alignof( std::max_align_t ) );
+  void        reset( void );
+  uint32_t    get_used( void );
+  uint32_t    get_size( void );
+  uint32_t    get_failed( void );
+
+  /*
+   * make - constructs an object in the arena, or returns nullptr if there's
+   *        no room left for it.
+   */
+
+  template<typename T, typename... A>
+  T          *make( A&&... p_args )
+  {
+    void *l_memory = this->alloc( sizeof( T ), alignof( T ) );
+    return l_memory ? new( l_memory ) T( std::forward<A>( p_args )... ) : nullptr;
+  }
+};
+
+
+/* End of file utils/arena.hpp */
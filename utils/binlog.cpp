@@ -0,0 +1,201 @@
+/*
+ * utils/binlog.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file implements the binary log; a lock free, single producer single
+ * consumer ring of format IDs and raw arguments, formatted only once they're
+ * read back out.
+ *
+ * Each entry in the ring is a header word (format ID in the low half, argument
+ * count in the high half), a timestamp word, and then the arguments.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <atomic>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/binlog.hpp"
+
+
+/* Module variables. */
+
+static uint32_t               m_ring[BINLOG_WORDS];
+static std::atomic<uint32_t>  m_head( 0 );
+static std::atomic<uint32_t>  m_tail( 0 );
+static uint32_t               m_dropped;
+
+static const char            *m_formats[LOG_MAX] = {
+#define BINLOG_STRING(id,format) format,
+  BINLOG_FORMATS( BINLOG_STRING )
+#undef BINLOG_STRING
+};
+
+static const char            *m_names[LOG_MAX] = {
+#define BINLOG_NAME(id,format) #id,
+  BINLOG_FORMATS( BINLOG_NAME )
+#undef BINLOG_NAME
+};
+
+
+/* Functions. */
+
+/*
+ * binlog_write - adds an entry to the ring; the producer's side. If there's
+ *                no room, the entry is dropped (and counted).
+ */
+
+void binlog_write( logformat_t p_format, uint32_t p_argc, const uint32_t *p_args )
+{
+  uint32_t l_head = m_head.load( std::memory_order_relaxed );
+  uint32_t l_tail = m_tail.load( std::memory_order_acquire );
+  uint32_t l_words = 2 + p_argc;
+
+  /* Make sure there's room for the whole entry. */
+  if ( BINLOG_WORDS - ( l_head - l_tail ) < l_words )
+  {
+    m_dropped++;
+    return;
+  }
+
+  /* Fill it in, and only then publish it to the reader. */
+  m_ring[l_head++ & ( BINLOG_WORDS - 1 )] = p_format | ( p_argc << 16 );
+  m_ring[l_head++ & ( BINLOG_WORDS - 1 )] = picosystem::time_us();
+  for ( uint32_t l_index = 0; l_index < p_argc; l_index++ )
+  {
+    m_ring[l_head++ & ( BINLOG_WORDS - 1 )] = p_args[l_index];
+  }
+  m_head.store( l_head, std::memory_order_release );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * binlog_read - takes the oldest entry off the ring; the consumer's side.
+ *               Returns false if the ring is empty.
+ */
+
+bool binlog_read( binlog_entry_t &p_entry )
+{
+  uint32_t l_tail = m_tail.load( std::memory_order_relaxed );
+  uint32_t l_head = m_head.load( std::memory_order_acquire );
+  uint32_t l_header;
+
+  if ( l_tail == l_head )
+  {
+    return false;
+  }
+
+  /* Unpack the header, and the arguments after it. */
+  l_header = m_ring[l_tail++ & ( BINLOG_WORDS - 1 )];
+  p_entry.format = l_header & 0xffff;
+  p_entry.argc = l_header >> 16;
+  p_entry.time_us = m_ring[l_tail++ & ( BINLOG_WORDS - 1 )];
+  for ( uint32_t l_index = 0; l_index < p_entry.argc; l_index++ )
+  {
+    p_entry.args[l_index] = m_ring[l_tail++ & ( BINLOG_WORDS - 1 )];
+  }
+
+  /* And hand the space back to the writer. */
+  m_tail.store( l_tail, std::memory_order_release );
+  return true;
+}
+
+
+/*
+ * binlog_get_dropped - returns how many entries didn't fit in the ring.
+ */
+
+uint32_t binlog_get_dropped( void )
+{
+  return m_dropped;
+}
+
+
+/*
+ * binlog_format - turns an entry into text. Any arguments the format doesn't
+ *                 use are simply ignored.
+ */
+
+void binlog_format( const binlog_entry_t &p_entry, char *p_buffer, uint32_t p_length )
+{
+  uint32_t l_args[BINLOG_MAX_ARGS] = {};
+
+  if ( p_entry.format >= LOG_MAX || p_entry.argc > BINLOG_MAX_ARGS )
+  {
+    snprintf( p_buffer, p_length, "unknown log entry %u", p_entry.format );
+    return;
+  }
+  for ( uint32_t l_index = 0; l_index < p_entry.argc; l_index++ )
+  {
+    l_args[l_index] = p_entry.args[l_index];
+  }
+  snprintf( p_buffer, p_length, m_formats[p_entry.format],
+            l_args[0], l_args[1], l_args[2], l_args[3] );
+  return;
+}
+
+
+/*
+ * binlog_format_name - returns the name of a format ID.
+ */
+
+const char *binlog_format_name( uint32_t p_format )
+{
+  return p_format < LOG_MAX ? m_names[p_format] : "???";
+}
+
+
+/*
+ * binlog_drain - formats up to the given number of entries out to a stream;
+ *                returns how many it wrote.
+ */
+
+uint32_t binlog_drain( FILE *p_stream, uint32_t p_max )
+{
+  binlog_entry_t  l_entry;
+  char            l_buffer[96];
+  uint32_t        l_count = 0;
+
+  while ( l_count < p_max && binlog_read( l_entry ) )
+  {
+    binlog_format( l_entry, l_buffer, sizeof( l_buffer ) );
+    fprintf( p_stream, "%10lu %s\n", (unsigned long)l_entry.time_us, l_buffer );
+    l_count++;
+  }
+  return l_count;
+}
+
+
+/*
+ * binlog_drain_raw - writes every pending entry out to a stream, exactly as
+ *                    it sat in the ring, for decoding later; returns how many
+ *                    it wrote.
+ */
+
+uint32_t binlog_drain_raw( FILE *p_stream )
+{
+  binlog_entry_t  l_entry;
+  uint32_t        l_count = 0, l_header;
+
+  while ( binlog_read( l_entry ) )
+  {
+    l_header = l_entry.format | ( l_entry.argc << 16 );
+    fwrite( &l_header, sizeof( l_header ), 1, p_stream );
+    fwrite( &l_entry.time_us, sizeof( l_entry.time_us ), 1, p_stream );
+    fwrite( l_entry.args, sizeof( uint32_t ), l_entry.argc, p_stream );
+    l_count++;
+  }
+  return l_count;
+}
+
+
+/* End of file utils/binlog.cpp */
@@ -0,0 +1,81 @@
+/*
+ * utils/binlog.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file defines the binary log; rather than formatting messages as they
+ * happen, a log call just drops a format ID, a timestamp and its raw arguments
+ * into a ring buffer. Formatting happens later; on the device, after the frame
+ * has been drawn (and only in debug builds, which have a serial port to write
+ * to), and on the host, offline from a raw dump of the ring.
+ *
+ * The ring has a single producer (the game) and a single consumer (whoever
+ * drains it), so it needs no locks; if it fills up, new entries are dropped
+ * and counted rather than ever blocking the game.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+/* System headers. */
+
+#include <cstdio>
+
+
+#define BINLOG_WORDS        1024          /* Must be a power of two. */
+#define BINLOG_MAX_ARGS     4
+#define BINLOG_IDLE_ENTRIES 8
+#define BINLOG_MAGIC        "PVL1"
+
+/*
+ * Every message the game can log, along with the format it's shown with; the
+ * arguments are all 32 bit values, so only integer conversions belong here.
+ */
+
+#define BINLOG_FORMATS(X) \
+  X( LOG_STATE,   "state %u -> %u" ) \
+  X( LOG_KILL,    "invader %u killed at column %u, row %u" ) \
+  X( LOG_SCORE,   "score %u -> %u" ) \
+  X( LOG_OVERRUN, "frame %u overran: %uus update, %uus draw" )
+
+typedef enum
+{
+#define BINLOG_ENUM(id,format) id,
+  BINLOG_FORMATS( BINLOG_ENUM )
+#undef BINLOG_ENUM
+  LOG_MAX
+} logformat_t;
+
+struct binlog_entry_t
+{
+  uint16_t    format;
+  uint16_t    argc;
+  uint32_t    time_us;
+  uint32_t    args[BINLOG_MAX_ARGS];
+};
+
+void        binlog_write( logformat_t, uint32_t, const uint32_t * );
+bool        binlog_read( binlog_entry_t & );
+uint32_t    binlog_get_dropped( void );
+void        binlog_format( const binlog_entry_t &, char *, uint32_t );
+const char *binlog_format_name( uint32_t );
+uint32_t    binlog_drain( FILE *, uint32_t );
+uint32_t    binlog_drain_raw( FILE * );
+
+/*
+ * BINLOG - logs a message, with up to BINLOG_MAX_ARGS integer arguments.
+ */
+
+template<typename... A>
+inline void binlog( logformat_t p_format, A... p_args )
+{
+  static_assert( sizeof...( A ) <= BINLOG_MAX_ARGS, "too many binlog arguments" );
+  const uint32_t l_args[sizeof...( A ) + 1] = { (uint32_t)p_args... };
+  binlog_write( p_format, sizeof...( A ), l_args );
+}
+
+#define BINLOG(...)         binlog( __VA_ARGS__ )
+
+
+/* End of file utils/binlog.hpp */
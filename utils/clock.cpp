@@ -0,0 +1,141 @@
+/*
+ * utils/clock.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file implements the GameClock class; the source of the frame deltas that
+ * drive every state. Normally this is just real time, but it can also hand out
+ * fixed steps, either paced to real time or as fast as the caller can take them.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/clock.hpp"
+
+
+/* Functions. */
+
+/*
+ * constructor - sets the mode, and starts the clock from now.
+ */
+
+GameClock::GameClock( clockmode_t p_mode, uint32_t p_step_ms )
+{
+  /* Just set the mode; that resets us too. */
+  this->set_mode( p_mode, p_step_ms );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * destructor - tidy up any allocated resources.
+ */
+
+GameClock::~GameClock()
+{
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_mode - selects how deltas are generated; the step is only used in the
+ *            fixed and unthrottled modes.
+ */
+
+void GameClock::set_mode( clockmode_t p_mode, uint32_t p_step_ms )
+{
+  /* Save the settings, and restart from now. */
+  this->m_mode = p_mode;
+  this->m_step_ms = p_step_ms;
+  this->reset();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * get_mode - returns the current clock mode.
+ */
+
+clockmode_t GameClock::get_mode( void )
+{
+  return this->m_mode;
+}
+
+
+/*
+ * reset - restarts the clock from now, with no time elapsed.
+ */
+
+void GameClock::reset( void )
+{
+  this->m_last_ms = picosystem::time();
+  this->m_time_ms = 0;
+  return;
+}
+
+
+/*
+ * get_delta - called once per frame; returns the milliseconds since the last
+ *             call. In the fixed mode, we wait for real time to catch up with
+ *             the step before returning it.
+ */
+
+uint32_t GameClock::get_delta( void )
+{
+  uint32_t l_delta, l_current_ms;
+
+  switch( this->m_mode )
+  {
+    case CLOCK_FIXED:
+      /* Wait until a full step has really passed, and then move on by one. */
+      while ( picosystem::time() - this->m_last_ms < this->m_step_ms )
+      {
+        picosystem::sleep( 1 );
+      }
+      this->m_last_ms += this->m_step_ms;
+      l_delta = this->m_step_ms;
+      break;
+
+    case CLOCK_UNTHROTTLED:
+      /* Time passes exactly as quickly as we ask it to. */
+      l_delta = this->m_step_ms;
+      break;
+
+    default:
+      /* Real time; it is what it is. */
+      l_current_ms = picosystem::time();
+      l_delta = l_current_ms - this->m_last_ms;
+      this->m_last_ms = l_current_ms;
+      break;
+  }
+
+  /* Keep a running total of simulated time. */
+  this->m_time_ms += l_delta;
+
+  /* All done. */
+  return l_delta;
+}
+
+
+/*
+ * get_time - returns the simulated milliseconds since the clock was reset.
+ */
+
+uint32_t GameClock::get_time( void )
+{
+  return this->m_time_ms;
+}
+
+
+/* End of file utils/clock.cpp */
@@ -0,0 +1,44 @@
+/*
+ * utils/clock.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file defines the GameClock class; the source of the frame deltas that
+ * drive every state. Normally this is just real time, but it can also hand out
+ * fixed steps, either paced to real time or as fast as the caller can take them.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#define CLOCK_DEFAULT_STEP_MS 25
+
+typedef enum
+{
+  CLOCK_REALTIME,
+  CLOCK_FIXED,
+  CLOCK_UNTHROTTLED
+} clockmode_t;
+
+class GameClock
+{
+private:
+  clockmode_t m_mode;
+  uint32_t    m_step_ms;
+  uint32_t    m_last_ms;
+  uint32_t    m_time_ms;
+
+public:
+              GameClock( clockmode_t = CLOCK_REALTIME, uint32_t = CLOCK_DEFAULT_STEP_MS );
+             ~GameClock();
+
+  void        set_mode( clockmode_t, uint32_t = CLOCK_DEFAULT_STEP_MS );
+  clockmode_t get_mode( void );
+  void        reset( void );
+  uint32_t    get_delta( void );
+  uint32_t    get_time( void );
+};
+
+
+/* End of file utils/clock.hpp */
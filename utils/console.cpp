@@ -0,0 +1,502 @@
+/*
+ * utils/console.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                    for the PicoSystem.
+ *
+ * This file implements the debug console; commands are gathered a character
+ * at a time, without ever blocking, and run once a whole line has arrived.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef PICOVADERS_HOST
+#include <poll.h>
+#include <unistd.h>
+#else
+#include "pico/stdlib.h"
+#endif
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "picovaders.hpp"
+#include "utils/console.hpp"
+#include "utils/flight.hpp"
+#include "utils/heap.hpp"
+#include "utils/power.hpp"
+#include "utils/stack.hpp"
+#include "utils/tunables.hpp"
+
+
+/* Module variables. */
+
+static bool         m_enabled;
+static bool         m_paused;
+static uint32_t     m_steps;
+static bool         m_state_requested;
+static gamestate_t  m_requested_state;
+static char         m_line[CONSOLE_LINE_LENGTH+1];
+static uint_fast8_t m_line_length;
+
+
+/* Functions. */
+
+/*
+ * read_char - fetches the next waiting character, if there is one; returns
+ *             -1 straight away if not.
+ */
+
+static int read_char( void )
+{
+#ifdef PICOVADERS_HOST
+  struct pollfd l_poll = { 0, POLLIN, 0 };
+  unsigned char l_char;
+
+  if ( poll( &l_poll, 1, 0 ) <= 0 || ( l_poll.revents & ( POLLIN | POLLHUP ) ) == 0 )
+  {
+    return -1;
+  }
+
+  /* Once stdin is closed, there's never going to be anything else. */
+  if ( read( 0, &l_char, 1 ) != 1 )
+  {
+    m_enabled = false;
+    return -1;
+  }
+  return l_char;
+#else
+  int l_char = getchar_timeout_us( 0 );
+  return l_char < 0 ? -1 : l_char;
+#endif
+}
+
+
+/*
+ * cmd_help - lists the commands we understand.
+ */
+
+static void cmd_help( void )
+{
+  printf( "commands:\n" );
+  printf( "  stats              frame timings over the flight recorder\n" );
+  printf( "  state              describe the current state\n" );
+  printf( "  state NAME         switch to splash, title or game\n" );
+  printf( "  flight             write out the flight recorder\n" );
+  printf( "  flight budget [US] show, or set, the frame time that dumps it\n" );
+  printf( "  heap               heap usage per state, and the stack\n" );
+  printf( "  power [on|off]     frames drawn and duty cycle per state; switch the governor\n" );
+  printf( "  pause / resume     stop and start updates; drawing carries on\n" );
+  printf( "  step [N]           while paused, run N updates (default 1)\n" );
+  printf( "  set [NAME VALUE]   list the tunables, or change one\n" );
+  return;
+}
+
+
+/*
+ * cmd_stats - summarises the frames held in the flight recorder.
+ */
+
+static void cmd_stats( void )
+{
+  static flight_frame_t l_frames[FLIGHT_FRAMES];
+  uint32_t              l_count, l_index;
+  uint32_t              l_update_total = 0, l_draw_total = 0, l_delta_total = 0;
+  uint32_t              l_update_max = 0, l_draw_max = 0, l_delta_max = 0;
+
+  l_count = flight_get_frames( l_frames, FLIGHT_FRAMES );
+  if ( l_count == 0 )
+  {
+    printf( "no frames recorded yet\n" );
+    return;
+  }
+
+  for ( l_index = 0; l_index < l_count; l_index++ )
+  {
+    l_update_total += l_frames[l_index].update_us;
+    l_draw_total += l_frames[l_index].draw_us;
+    l_delta_total += l_frames[l_index].delta_ms;
+    l_update_max = std::max<uint32_t>( l_update_max, l_frames[l_index].update_us );
+    l_draw_max = std::max<uint32_t>( l_draw_max, l_frames[l_index].draw_us );
+    l_delta_max = std::max<uint32_t>( l_delta_max, l_frames[l_index].delta_ms );
+  }
+
+  printf( "last %lu frames (to frame %lu):\n", (unsigned long)l_count,
+          (unsigned long)l_frames[l_count-1].frame );
+  printf( "  delta  avg %5lums max %5lums\n", (unsigned long)( l_delta_total / l_count ),
+          (unsigned long)l_delta_max );
+  printf( "  update avg %5luus max %5luus\n", (unsigned long)( l_update_total / l_count ),
+          (unsigned long)l_update_max );
+  printf( "  draw   avg %5luus max %5luus\n", (unsigned long)( l_draw_total / l_count ),
+          (unsigned long)l_draw_max );
+  printf( "  %lu frames over budget%s\n", (unsigned long)flight_get_overruns(),
+          m_paused ? "; paused" : "" );
+  return;
+}
+
+
+/*
+ * cmd_flight - with no arguments, writes out the flight recorder (a few lines
+ *              a frame, on the device); otherwise, shows or sets the budget
+ *              over which it's written out by itself.
+ */
+
+static void cmd_flight( const char *p_setting, const char *p_value )
+{
+  if ( p_setting == nullptr )
+  {
+    flight_request_dump( "on demand" );
+  }
+  else if ( strcmp( p_setting, "budget" ) != 0 )
+  {
+    printf( "flight takes nothing, or 'budget [US]'\n" );
+  }
+  else
+  {
+    if ( p_value != nullptr )
+    {
+      flight_set_budget( strtoul( p_value, nullptr, 10 ) );
+    }
+    printf( "flight budget %luus%s\n", (unsigned long)flight_get_budget(),
+            flight_get_budget() == 0 ? "; never dumps by itself" : "" );
+  }
+  return;
+}
+
+
+/*
+ * cmd_heap - shows what each state has allocated, and how deep the stack has
+ *            gone.
+ */
+
+static void cmd_heap( void )
+{
+  heap_stats_t  l_stats;
+  uint_fast8_t  l_state;
+
+  heap_get_total( l_stats );
+  if ( l_stats.allocs == 0 )
+  {
+    printf( "no heap allocations\n" );
+  }
+  else
+  {
+    printf( "%-8s %7s %7s %7s %7s\n", "heap", "live", "bytes", "peak", "largest" );
+  }
+  for ( l_state = 0; l_state <= GAMESTATE_MAX; l_state++ )
+  {
+    heap_get_stats( (gamestate_t)l_state, l_stats );
+    if ( l_stats.allocs == 0 )
+    {
+      continue;
+    }
+    printf( "%-8s %7lu %7lu %7lu %7lu\n", gamestate_name( (gamestate_t)l_state ),
+            (unsigned long)l_stats.live_blocks, (unsigned long)l_stats.live_bytes,
+            (unsigned long)l_stats.peak_bytes, (unsigned long)l_stats.largest_block );
+  }
+
+  if ( stack_enabled() )
+  {
+    printf( "stack high water %lub of %lub\n", (unsigned long)stack_get_high_water(),
+            (unsigned long)stack_get_size() );
+  }
+  return;
+}
+
+
+/*
+ * cmd_power - with no argument, shows how hard each state has worked the core;
+ *             otherwise, turns the power governor on or off.
+ */
+
+static void cmd_power( const char *p_setting )
+{
+  if ( p_setting == nullptr )
+  {
+    power_describe( stdout );
+  }
+  else if ( strcmp( p_setting, "on" ) == 0 || strcmp( p_setting, "off" ) == 0 )
+  {
+    power_enable( strcmp( p_setting, "on" ) == 0 );
+    printf( "governor %s\n", p_setting );
+  }
+  else
+  {
+    printf( "power takes 'on' or 'off'\n" );
+  }
+  return;
+}
+
+
+/*
+ * cmd_state - with no argument, describes the current state; otherwise,
+ *             requests a switch into the one named.
+ */
+
+static void cmd_state( const char *p_name )
+{
+  GameStateInterface *l_state = get_current_state();
+  uint_fast8_t        l_index;
+
+  if ( p_name == nullptr )
+  {
+    if ( l_state == nullptr )
+    {
+      printf( "no current state\n" );
+    }
+    else
+    {
+      l_state->describe( stdout );
+    }
+    return;
+  }
+
+  /* Death isn't a state that can stand on its own, so it's not offered. */
+  for ( l_index = 0; l_index < GAMESTATE_DEATH; l_index++ )
+  {
+    if ( strcmp( p_name, gamestate_name( (gamestate_t)l_index ) ) == 0 )
+    {
+      m_requested_state = (gamestate_t)l_index;
+      m_state_requested = true;
+      printf( "switching to %s\n", p_name );
+      return;
+    }
+  }
+  printf( "unknown state '%s'\n", p_name );
+  return;
+}
+
+
+/*
+ * cmd_set - with no arguments, lists the tunables; otherwise, changes one.
+ */
+
+static void cmd_set( const char *p_name, const char *p_value )
+{
+  const tunable_info_t *l_info;
+  tunable_t             l_tunable;
+  uint_fast8_t          l_index;
+
+  if ( p_name == nullptr )
+  {
+    for ( l_index = 0; l_index < TUNE_MAX; l_index++ )
+    {
+      l_info = tunable_get_info( (tunable_t)l_index );
+      printf( "  %-18s %5ld  (default %ld, %ld-%ld)\n", l_info->name,
+              (long)tunable_get( (tunable_t)l_index ), (long)l_info->value,
+              (long)l_info->min, (long)l_info->max );
+    }
+    return;
+  }
+
+  if ( !tunable_find( p_name, l_tunable ) )
+  {
+    printf( "unknown tunable '%s'\n", p_name );
+  }
+  else if ( p_value == nullptr || !tunable_set( l_tunable, strtol( p_value, nullptr, 10 ) ) )
+  {
+    l_info = tunable_get_info( l_tunable );
+#ifdef PICOVADERS_TUNABLES
+    printf( "%s takes a value from %ld to %ld\n", p_name, (long)l_info->min, (long)l_info->max );
+#else
+    printf( "%s is fixed at %ld in this build\n", p_name, (long)l_info->value );
+#endif
+  }
+  else
+  {
+    printf( "%s = %ld\n", p_name, (long)tunable_get( l_tunable ) );
+
+    /* A tunable can change what's drawn, without the state knowing. */
+    if ( get_current_state() != nullptr )
+    {
+      get_current_state()->mark_dirty();
+    }
+  }
+  return;
+}
+
+
+/*
+ * console_enable - turns the console on (or off); until it's enabled, no
+ *                  input is ever read.
+ */
+
+void console_enable( bool p_enable )
+{
+  m_enabled = p_enable;
+  m_line_length = 0;
+  if ( p_enable )
+  {
+    printf( "debug console ready; 'help' for commands\n" );
+  }
+  return;
+}
+
+
+/*
+ * console_enabled - reports whether the console is listening.
+ */
+
+bool console_enabled( void )
+{
+  return m_enabled;
+}
+
+
+/*
+ * console_poll - gathers whatever input is waiting, running any commands that
+ *                have been completed; called once a frame, and never blocks.
+ */
+
+void console_poll( void )
+{
+  int l_char;
+
+  while ( m_enabled && ( l_char = read_char() ) >= 0 )
+  {
+    if ( l_char == '\r' || l_char == '\n' )
+    {
+      m_line[m_line_length] = '\0';
+      m_line_length = 0;
+      console_execute( m_line );
+    }
+    else if ( m_line_length < CONSOLE_LINE_LENGTH )
+    {
+      m_line[m_line_length++] = (char)l_char;
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * console_execute - runs a single command line.
+ */
+
+void console_execute( const char *p_line )
+{
+  char        l_buffer[CONSOLE_LINE_LENGTH+1];
+  const char *l_command, *l_argument, *l_value;
+
+  /* Split off the command and its arguments; no command takes more than two. */
+  strncpy( l_buffer, p_line, CONSOLE_LINE_LENGTH );
+  l_buffer[CONSOLE_LINE_LENGTH] = '\0';
+  l_command = strtok( l_buffer, " \t" );
+  l_argument = strtok( nullptr, " \t" );
+  l_value = strtok( nullptr, " \t" );
+
+  if ( l_command == nullptr )
+  {
+    return;
+  }
+  else if ( strcmp( l_command, "help" ) == 0 )
+  {
+    cmd_help();
+  }
+  else if ( strcmp( l_command, "stats" ) == 0 )
+  {
+    cmd_stats();
+  }
+  else if ( strcmp( l_command, "state" ) == 0 )
+  {
+    cmd_state( l_argument );
+  }
+  else if ( strcmp( l_command, "flight" ) == 0 )
+  {
+    cmd_flight( l_argument, l_value );
+  }
+  else if ( strcmp( l_command, "heap" ) == 0 )
+  {
+    cmd_heap();
+  }
+  else if ( strcmp( l_command, "power" ) == 0 )
+  {
+    cmd_power( l_argument );
+  }
+  else if ( strcmp( l_command, "pause" ) == 0 )
+  {
+    m_paused = true;
+    m_steps = 0;
+    printf( "paused\n" );
+  }
+  else if ( strcmp( l_command, "resume" ) == 0 )
+  {
+    m_paused = false;
+    printf( "resumed\n" );
+  }
+  else if ( strcmp( l_command, "step" ) == 0 )
+  {
+    m_paused = true;
+    m_steps += l_argument ? strtoul( l_argument, nullptr, 10 ) : 1;
+  }
+  else if ( strcmp( l_command, "set" ) == 0 )
+  {
+    cmd_set( l_argument, l_value );
+  }
+  else
+  {
+    printf( "unknown command '%s'; try 'help'\n", l_command );
+  }
+
+  /* Make sure the answer gets out, whatever's on the other end. */
+  fflush( stdout );
+  return;
+}
+
+
+/*
+ * console_should_update - decides whether the current state gets to update
+ *                         this frame; when paused, only if a step is owed.
+ */
+
+bool console_should_update( void )
+{
+  if ( !m_paused )
+  {
+    return true;
+  }
+  if ( m_steps > 0 )
+  {
+    m_steps--;
+    return true;
+  }
+  return false;
+}
+
+
+/*
+ * console_take_state_request - hands over a state switch asked for at the
+ *                              console, if there's one waiting.
+ */
+
+bool console_take_state_request( gamestate_t &p_state )
+{
+  if ( !m_state_requested )
+  {
+    return false;
+  }
+  m_state_requested = false;
+  p_state = m_requested_state;
+  return true;
+}
+
+
+/*
+ * console_paused - reports whether updates have been paused.
+ */
+
+bool console_paused( void )
+{
+  return m_paused;
+}
+
+
+/* End of file utils/console.cpp */
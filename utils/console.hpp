@@ -0,0 +1,35 @@
+/*
+ * utils/console.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                    for the PicoSystem.
+ *
+ * This file defines the debug console; a simple line-based command prompt,
+ * read over USB serial on the device and from stdin on the host. It can dump
+ * the frame, heap and stack statistics, describe the current state, pause and
+ * single-step the game, and force a switch into any state.
+ *
+ * Input is polled once per frame and never blocks; nothing is read at all
+ * until console_enable() is called. The console only exists when
+ * PICOVADERS_CONSOLE is defined, which DEBUG and host builds do.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#if ( defined(DEBUG) || defined(PICOVADERS_HOST) ) && !defined(PICOVADERS_CONSOLE)
+#define PICOVADERS_CONSOLE 1
+#endif
+
+#define CONSOLE_LINE_LENGTH   64
+
+void        console_enable( bool );
+bool        console_enabled( void );
+void        console_poll( void );
+void        console_execute( const char * );
+bool        console_should_update( void );
+bool        console_take_state_request( gamestate_t & );
+bool        console_paused( void );
+
+
+/* End of file utils/console.hpp */
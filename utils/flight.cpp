@@ -0,0 +1,342 @@
+/*
+ * utils/flight.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file implements the flight recorder; a small summary of every frame is
+ * kept in a ring covering the last few hundred frames, and the whole ring is
+ * dumped when a frame runs over budget (or when asked). On the device, an
+ * overrun's dump is written out a few lines at a time, after each frame has
+ * been drawn, rather than all at once.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "picovaders.hpp"
+#include "utils/binlog.hpp"
+#include "utils/flight.hpp"
+#include "utils/profiler.hpp"
+
+
+/* Module variables. */
+
+static flight_frame_t m_frames[FLIGHT_FRAMES];
+static flight_frame_t m_current;
+static uint32_t       m_frame_count;
+static uint32_t       m_overruns;
+static uint32_t       m_quiet_until;
+static FILE          *m_output;
+static uint32_t       m_drain_next;
+static uint32_t       m_drain_end;
+static bool           m_drain_header;
+static char           m_drain_reason[64];
+
+/* The profiler phases kept in each frame, in the order they're written out. */
+static const profilephase_t m_phases[FLIGHT_PHASES] = {
+  PROFILE_EXPLOSIONS, PROFILE_BULLET, PROFILE_SHEET_SCAN, PROFILE_INVADERS,
+  PROFILE_PLAYER, PROFILE_DRAW_CLEAR, PROFILE_DRAW_SHEET, PROFILE_DRAW_SPRITES,
+  PROFILE_DRAW_TEXT
+};
+
+/* On the host, the tools decide whether they want dumps at all; on the device */
+/* they go out over the USB serial port, which only debug builds set up.       */
+#if defined(PICOVADERS_HOST) || !defined(DEBUG)
+static uint32_t       m_budget_us = 0;
+#else
+static uint32_t       m_budget_us = FLIGHT_DEFAULT_BUDGET_US;
+#endif
+
+
+/* Functions. */
+
+/*
+ * clamp16 and clamp8 - squeeze a count into the space we keep for it.
+ */
+
+static inline uint16_t clamp16( uint32_t p_value )
+{
+  return std::min( p_value, (uint32_t)UINT16_MAX );
+}
+static inline uint8_t clamp8( uint32_t p_value )
+{
+  return std::min( p_value, (uint32_t)UINT8_MAX );
+}
+
+
+/*
+ * write_header - writes the line explaining a dump, and the CSV header.
+ */
+
+static void write_header( FILE *p_output, const char *p_reason, uint32_t p_count )
+{
+  fprintf( p_output, "# flight recorder: %s; last %lu frames\n",
+           p_reason ? p_reason : "on demand", (unsigned long)p_count );
+  fprintf( p_output, "frame,state,delta_ms,update_us,draw_us,"
+                     "explosions_us,bullet_us,scan_us,invaders_us,player_us,"
+                     "clear_us,sheet_us,sprites_us,text_us,"
+                     "explosion_ticks,bullet_ticks,invader_ticks,base_ticks,"
+                     "explosions,invaders\n" );
+}
+
+
+/*
+ * write_frame - writes a single frame from the ring, as a CSV line.
+ */
+
+static void write_frame( FILE *p_output, const flight_frame_t &p_frame )
+{
+  fprintf( p_output, "%lu,%s,%u,%u,%u,", (unsigned long)p_frame.frame,
+           gamestate_name( (gamestate_t)p_frame.state ),
+           p_frame.delta_ms, p_frame.update_us, p_frame.draw_us );
+  for ( uint16_t l_phase_us : p_frame.phase_us )
+  {
+    fprintf( p_output, "%u,", l_phase_us );
+  }
+  fprintf( p_output, "%u,%u,%u,%u,%u,%u\n",
+           p_frame.ticks[FLIGHT_TICK_EXPLOSION], p_frame.ticks[FLIGHT_TICK_BULLET],
+           p_frame.ticks[FLIGHT_TICK_INVADER], p_frame.ticks[FLIGHT_TICK_BASE],
+           p_frame.explosions, p_frame.invaders );
+}
+
+
+/*
+ * flight_begin_frame - starts recording a new frame.
+ */
+
+void flight_begin_frame( uint32_t p_delta, gamestate_t p_state )
+{
+  m_current = {};
+  m_current.frame = m_frame_count;
+  m_current.delta_ms = clamp16( p_delta );
+  m_current.state = p_state;
+  return;
+}
+
+
+/*
+ * flight_set_ticks - notes how many times a ticker fired this frame; more
+ *                    than one means it was catching up.
+ */
+
+void flight_set_ticks( flighttick_t p_ticker, uint32_t p_count )
+{
+  m_current.ticks[p_ticker] = clamp8( p_count );
+  return;
+}
+
+
+/*
+ * flight_set_counts - notes how many explosions and invaders were active.
+ */
+
+void flight_set_counts( uint32_t p_explosions, uint32_t p_invaders )
+{
+  m_current.explosions = clamp8( p_explosions );
+  m_current.invaders = clamp8( p_invaders );
+  return;
+}
+
+
+/*
+ * flight_set_update and flight_set_draw - note how long each phase took.
+ */
+
+void flight_set_update( uint32_t p_us )
+{
+  m_current.update_us = clamp16( p_us );
+  return;
+}
+void flight_set_draw( uint32_t p_us )
+{
+  m_current.draw_us = clamp16( p_us );
+  return;
+}
+
+
+/*
+ * flight_end_frame - files the frame away in the ring, along with where the
+ *                    profiler saw the time go, and dumps the ring if it went
+ *                    over budget. Once dumped, we wait for the ring to fill
+ *                    with fresh frames before dumping again.
+ */
+
+void flight_end_frame( void )
+{
+  uint32_t l_frame_us = m_current.update_us + m_current.draw_us;
+  char     l_reason[sizeof( m_drain_reason )];
+
+  for ( uint_fast8_t l_phase = 0; l_phase < FLIGHT_PHASES; l_phase++ )
+  {
+    m_current.phase_us[l_phase] = clamp16( profiler_get_current( m_phases[l_phase] ) );
+  }
+  m_frames[m_frame_count % FLIGHT_FRAMES] = m_current;
+  m_frame_count++;
+
+  if ( m_budget_us > 0 && l_frame_us > m_budget_us )
+  {
+    BINLOG( LOG_OVERRUN, m_current.frame, m_current.update_us, m_current.draw_us );
+    m_overruns++;
+    if ( m_frame_count >= m_quiet_until )
+    {
+      snprintf( l_reason, sizeof( l_reason ), "frame %lu took %luus",
+                (unsigned long)m_current.frame, (unsigned long)l_frame_us );
+      flight_request_dump( l_reason );
+      m_quiet_until = m_frame_count + FLIGHT_FRAMES;
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * flight_set_budget - sets the frame time, in microseconds, over which the
+ *                     ring is dumped; zero never dumps automatically.
+ */
+
+void flight_set_budget( uint32_t p_budget_us )
+{
+  m_budget_us = p_budget_us;
+  return;
+}
+
+
+/*
+ * flight_get_budget - returns the frame time over which the ring is dumped.
+ */
+
+uint32_t flight_get_budget( void )
+{
+  return m_budget_us;
+}
+
+
+/*
+ * flight_set_output - sets the stream dumps are written to; stdout (which is
+ *                     the USB serial on the device) if not set.
+ */
+
+void flight_set_output( FILE *p_output )
+{
+  m_output = p_output;
+  return;
+}
+
+
+/*
+ * flight_get_overruns - returns how many frames have gone over budget.
+ */
+
+uint32_t flight_get_overruns( void )
+{
+  return m_overruns;
+}
+
+
+/*
+ * flight_get_frames - copies out up to the requested number of the most
+ *                     recent frames, oldest first; returns how many it copied.
+ */
+
+uint32_t flight_get_frames( flight_frame_t *p_frames, uint32_t p_max )
+{
+  uint32_t l_count = std::min( { p_max, m_frame_count, (uint32_t)FLIGHT_FRAMES } );
+
+  for ( uint32_t l_index = 0; l_index < l_count; l_index++ )
+  {
+    p_frames[l_index] = m_frames[( m_frame_count - l_count + l_index ) % FLIGHT_FRAMES];
+  }
+  return l_count;
+}
+
+
+/*
+ * flight_dump - writes out every frame in the ring, oldest first, as CSV.
+ */
+
+void flight_dump( const char *p_reason )
+{
+  FILE           *l_output = m_output ? m_output : stdout;
+  uint32_t        l_count = std::min( m_frame_count, (uint32_t)FLIGHT_FRAMES );
+
+  write_header( l_output, p_reason, l_count );
+  for ( uint32_t l_index = 0; l_index < l_count; l_index++ )
+  {
+    write_frame( l_output, m_frames[( m_frame_count - l_count + l_index ) % FLIGHT_FRAMES] );
+  }
+  fflush( l_output );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * flight_request_dump - asks for the ring to be written out. On the host it's
+ *                       written straight away; on the device, writing it all
+ *                       at once would only make a late frame later, so it's
+ *                       queued for flight_drain() to write from idle time.
+ */
+
+void flight_request_dump( const char *p_reason )
+{
+  snprintf( m_drain_reason, sizeof( m_drain_reason ), "%s",
+            p_reason ? p_reason : "on demand" );
+#ifdef PICOVADERS_HOST
+  flight_dump( m_drain_reason );
+#else
+  m_drain_end = m_frame_count;
+  m_drain_next = m_frame_count - std::min( m_frame_count, (uint32_t)FLIGHT_FRAMES );
+  m_drain_header = true;
+#endif
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * flight_drain - writes up to the given number of lines of a pending dump;
+ *                returns how many it wrote. Frames that have been overwritten
+ *                in the ring while waiting are skipped.
+ */
+
+uint32_t flight_drain( uint32_t p_max )
+{
+  FILE     *l_output = m_output ? m_output : stdout;
+  uint32_t  l_lines = 0;
+
+  if ( m_drain_header && l_lines < p_max )
+  {
+    write_header( l_output, m_drain_reason, m_drain_end - m_drain_next );
+    m_drain_header = false;
+    l_lines++;
+  }
+  m_drain_next = std::max( m_drain_next,
+                           m_frame_count - std::min( m_frame_count, (uint32_t)FLIGHT_FRAMES ) );
+  while ( m_drain_next < m_drain_end && l_lines < p_max )
+  {
+    write_frame( l_output, m_frames[m_drain_next % FLIGHT_FRAMES] );
+    m_drain_next++;
+    l_lines++;
+  }
+  if ( l_lines > 0 )
+  {
+    fflush( l_output );
+  }
+
+  /* All done. */
+  return l_lines;
+}
+
+
+/* End of file utils/flight.cpp */
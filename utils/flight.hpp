@@ -0,0 +1,72 @@
+/*
+ * utils/flight.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file defines the flight recorder; a small summary of every frame (its
+ * delta, update and draw times and the profiler's phase timings within them,
+ * how many times each ticker caught up, and how busy the sheet was) is kept
+ * in a ring covering the last few hundred frames. When a frame runs over
+ * budget (or when asked, at the console), the whole ring is dumped, so that
+ * whatever led up to the stutter can be seen after the fact. On the device,
+ * that dump is written out a few lines after each frame is drawn, and only by
+ * debug builds, which are the only ones with the USB serial port set up.
+ *
+ * It's cheap enough to be always on, in every build; the phase timings are
+ * only filled in by builds that run the profiler, though.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+/* System headers. */
+
+#include <cstdio>
+
+
+#define FLIGHT_FRAMES             256
+#define FLIGHT_DEFAULT_BUDGET_US  25000
+#define FLIGHT_IDLE_LINES         8
+#define FLIGHT_PHASES             9
+
+typedef enum
+{
+  FLIGHT_TICK_EXPLOSION,
+  FLIGHT_TICK_BULLET,
+  FLIGHT_TICK_INVADER,
+  FLIGHT_TICK_BASE,
+  FLIGHT_TICK_MAX
+} flighttick_t;
+
+struct flight_frame_t
+{
+  uint32_t    frame;
+  uint16_t    delta_ms;
+  uint16_t    update_us;
+  uint16_t    draw_us;
+  uint16_t    phase_us[FLIGHT_PHASES];
+  uint8_t     state;
+  uint8_t     ticks[FLIGHT_TICK_MAX];
+  uint8_t     explosions;
+  uint8_t     invaders;
+};
+
+void        flight_begin_frame( uint32_t, gamestate_t );
+void        flight_set_ticks( flighttick_t, uint32_t );
+void        flight_set_counts( uint32_t, uint32_t );
+void        flight_set_update( uint32_t );
+void        flight_set_draw( uint32_t );
+void        flight_end_frame( void );
+
+void        flight_set_budget( uint32_t );
+uint32_t    flight_get_budget( void );
+void        flight_set_output( FILE * );
+uint32_t    flight_get_overruns( void );
+uint32_t    flight_get_frames( flight_frame_t *, uint32_t );
+void        flight_dump( const char * );
+void        flight_request_dump( const char * );
+uint32_t    flight_drain( uint32_t );
+
+
+/* End of file utils/flight.hpp */
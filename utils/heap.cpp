@@ -0,0 +1,316 @@
+/*
+ * utils/heap.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                 for the PicoSystem.
+ *
+ * This file implements the heap tracker; every allocation made through operator
+ * new is counted against whichever game state was active when it was made,
+ * so we can see how much memory each state really uses, and where the churn
+ * comes from. In strict mode, any allocation made while GameState is running
+ * is treated as a bug, and stops the game dead.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "picovaders.hpp"
+#include "utils/heap.hpp"
+
+
+/* Constants. */
+
+#define HEAP_MAGIC        0x50564850    /* "PVHP" */
+
+/*
+ * Every block carries a small header, recording its size and owner so that
+ * a free can be credited back to the right state. It's padded to keep the
+ * caller's memory as aligned as malloc would have made it.
+ */
+
+union heap_header_t
+{
+  struct
+  {
+    uint32_t      magic;
+    uint32_t      size;
+    uint8_t       state;
+  }               info;
+  std::max_align_t align;
+};
+
+
+/* Module variables. */
+
+static heap_stats_t   m_stats[HEAP_STATES];
+static heap_stats_t   m_total;
+static uint8_t        m_state = GAMESTATE_MAX;
+static uint8_t        m_owner = GAMESTATE_MAX;
+static bool           m_running;
+static bool           m_strict;
+
+
+/* Functions. */
+
+/*
+ * heap_enter_state - makes the given state the current one, and attributes
+ *                    everything allocated to it until heap_set_running is
+ *                    next called; so call it just before creating the state.
+ */
+
+void heap_enter_state( gamestate_t p_state )
+{
+  m_state = p_state < GAMESTATE_MAX ? p_state : GAMESTATE_MAX;
+  m_owner = m_state;
+  m_running = false;
+  return;
+}
+
+
+/*
+ * heap_set_running - marks whether the current state's update or draw is
+ *                    running. Allocations are only attributed to the state
+ *                    while it is (anything else, such as the host tools, is
+ *                    counted outside of any state), and it's only then that
+ *                    strict mode applies.
+ */
+
+void heap_set_running( bool p_running )
+{
+  m_running = p_running;
+  m_owner = p_running ? m_state : (uint8_t)GAMESTATE_MAX;
+  return;
+}
+
+
+/*
+ * heap_set_strict - turns strict mode on or off; when on, any allocation made
+ *                   by a running GameState aborts the game.
+ */
+
+void heap_set_strict( bool p_strict )
+{
+  m_strict = p_strict;
+  return;
+}
+
+
+/*
+ * heap_get_strict - returns whether strict mode is on.
+ */
+
+bool heap_get_strict( void )
+{
+  return m_strict;
+}
+
+
+/*
+ * heap_get_stats - fills in the statistics for a single state.
+ */
+
+void heap_get_stats( gamestate_t p_state, heap_stats_t &p_stats )
+{
+  p_stats = m_stats[p_state < GAMESTATE_MAX ? p_state : GAMESTATE_MAX];
+  return;
+}
+
+
+/*
+ * heap_get_total - fills in the statistics across every state.
+ */
+
+void heap_get_total( heap_stats_t &p_stats )
+{
+  p_stats = m_total;
+  return;
+}
+
+
+/*
+ * heap_reset_peaks - brings every high water mark back down to what's live now.
+ */
+
+void heap_reset_peaks( void )
+{
+  for ( heap_stats_t &l_stats : m_stats )
+  {
+    l_stats.peak_bytes = l_stats.live_bytes;
+  }
+  m_total.peak_bytes = m_total.live_bytes;
+  return;
+}
+
+
+/*
+ * count_alloc - adds a new block to a set of statistics.
+ */
+
+static void count_alloc( heap_stats_t &p_stats, uint32_t p_size )
+{
+  p_stats.allocs++;
+  p_stats.live_blocks++;
+  p_stats.live_bytes += p_size;
+  if ( p_stats.live_bytes > p_stats.peak_bytes )
+  {
+    p_stats.peak_bytes = p_stats.live_bytes;
+  }
+  if ( p_size > p_stats.largest_block )
+  {
+    p_stats.largest_block = p_size;
+  }
+  return;
+}
+
+
+/*
+ * count_free - removes a block from a set of statistics.
+ */
+
+static void count_free( heap_stats_t &p_stats, uint32_t p_size )
+{
+  p_stats.frees++;
+  p_stats.live_blocks--;
+  p_stats.live_bytes -= p_size;
+  return;
+}
+
+
+/*
+ * heap_alloc - allocates a tracked block; returns nullptr if we're out of
+ *              memory. In strict mode, allocating during GameState aborts.
+ */
+
+void *heap_alloc( size_t p_size )
+{
+  heap_header_t  *l_header;
+
+  /* Gameplay is supposed to run without touching the heap at all. */
+  if ( m_strict && m_running && m_state == GAMESTATE_GAME )
+  {
+    printf( "heap: %u byte allocation while GameState is running\n", (uint32_t)p_size );
+    fflush( stdout );
+    abort();
+  }
+
+  /* Grab the memory, with room for our header. */
+  l_header = (heap_header_t *)malloc( sizeof( heap_header_t ) + p_size );
+  if ( l_header == nullptr )
+  {
+    return nullptr;
+  }
+  l_header->info.magic = HEAP_MAGIC;
+  l_header->info.size = p_size;
+  l_header->info.state = m_owner;
+
+  /* Count it, against the state and overall. */
+  count_alloc( m_stats[m_owner], p_size );
+  count_alloc( m_total, p_size );
+
+  /* All done. */
+  return l_header + 1;
+}
+
+
+/*
+ * heap_free - releases a tracked block, crediting it back to the state that
+ *             allocated it.
+ */
+
+void heap_free( void *p_block )
+{
+  heap_header_t  *l_header;
+
+  if ( p_block == nullptr )
+  {
+    return;
+  }
+
+  /* Find our header, and make sure it is one. */
+  l_header = (heap_header_t *)p_block - 1;
+  if ( l_header->info.magic != HEAP_MAGIC )
+  {
+    printf( "heap: freeing an untracked block at %p\n", p_block );
+    fflush( stdout );
+    abort();
+  }
+  l_header->info.magic = 0;
+
+  /* Uncount it, and release it. */
+  count_free( m_stats[l_header->info.state], l_header->info.size );
+  count_free( m_total, l_header->info.size );
+  free( l_header );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * The operator new/delete replacements themselves; everything funnels through
+ * heap_alloc and heap_free.
+ */
+
+#ifdef PICOVADERS_HEAP_TRACK
+
+void *operator new( size_t p_size )
+{
+  void *l_block = heap_alloc( p_size );
+  if ( l_block == nullptr )
+  {
+#ifdef __cpp_exceptions
+    throw std::bad_alloc();
+#else
+    abort();
+#endif
+  }
+  return l_block;
+}
+
+void *operator new[]( size_t p_size )
+{
+  return operator new( p_size );
+}
+
+void *operator new( size_t p_size, const std::nothrow_t & ) noexcept
+{
+  return heap_alloc( p_size );
+}
+
+void *operator new[]( size_t p_size, const std::nothrow_t & ) noexcept
+{
+  return heap_alloc( p_size );
+}
+
+void operator delete( void *p_block ) noexcept
+{
+  heap_free( p_block );
+}
+
+void operator delete[]( void *p_block ) noexcept
+{
+  heap_free( p_block );
+}
+
+void operator delete( void *p_block, size_t ) noexcept
+{
+  heap_free( p_block );
+}
+
+void operator delete[]( void *p_block, size_t ) noexcept
+{
+  heap_free( p_block );
+}
+
+#endif /* PICOVADERS_HEAP_TRACK */
+
+
+/* End of file utils/heap.cpp */
@@ -0,0 +1,46 @@
+/*
+ * utils/heap.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                 for the PicoSystem.
+ *
+ * This file defines the heap tracker; every allocation made through operator
+ * new is counted against whichever game state was active when it was made,
+ * so we can see how much memory each state really uses, and where the churn
+ * comes from. In strict mode, any allocation made while GameState is running
+ * is treated as a bug, and stops the game dead.
+ *
+ * The operator new/delete hooks are only installed if PICOVADERS_HEAP_TRACK is
+ * defined, as it always is on the host. On the device, the SDK provides its own
+ * replacements, so it has to be asked for explicitly.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+/* Allocations made outside of any state are attributed to GAMESTATE_MAX. */
+#define HEAP_STATES       ( GAMESTATE_MAX + 1 )
+
+struct heap_stats_t
+{
+  uint32_t  allocs;
+  uint32_t  frees;
+  uint32_t  live_blocks;
+  uint32_t  live_bytes;
+  uint32_t  peak_bytes;
+  uint32_t  largest_block;
+};
+
+void        heap_enter_state( gamestate_t );
+void        heap_set_running( bool );
+void        heap_set_strict( bool );
+bool        heap_get_strict( void );
+void        heap_get_stats( gamestate_t, heap_stats_t & );
+void        heap_get_total( heap_stats_t & );
+void        heap_reset_peaks( void );
+
+void       *heap_alloc( size_t );
+void        heap_free( void * );
+
+
+/* End of file utils/heap.hpp */
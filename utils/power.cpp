@@ -0,0 +1,165 @@
+/*
+ * utils/power.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file implements the power governor; it decides whether each frame
+ * needs drawing, sleeps away the time until the next thing happens, and keeps
+ * track of how busy each state kept the core.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "picovaders.hpp"
+#include "utils/power.hpp"
+
+
+/* Module variables. */
+
+static bool           m_enabled;
+static bool           m_drawing = true;
+static uint32_t       m_frame_start_us;
+static uint32_t       m_delta_us;
+static power_stats_t  m_stats[POWER_STATES];
+
+
+/* Functions. */
+
+/*
+ * power_enable - turns the governor on or off; when off, every frame is drawn
+ *                and nothing sleeps, but the stats are still kept.
+ */
+
+void power_enable( bool p_enabled )
+{
+  m_enabled = p_enabled;
+  return;
+}
+
+
+/*
+ * power_enabled - returns whether the governor is on.
+ */
+
+bool power_enabled( void )
+{
+  return m_enabled;
+}
+
+
+/*
+ * power_begin_frame - starts timing a frame, given its delta in milliseconds.
+ */
+
+void power_begin_frame( uint32_t p_delta_ms )
+{
+  m_frame_start_us = picosystem::time_us();
+  m_delta_us = p_delta_ms * 1000;
+  return;
+}
+
+
+/*
+ * power_should_draw - decides whether this frame gets drawn; with the governor
+ *                     on, only if something on screen has changed.
+ */
+
+bool power_should_draw( bool p_dirty )
+{
+  m_drawing = !m_enabled || p_dirty;
+  return m_drawing;
+}
+
+
+/*
+ * power_end_frame - closes off a frame for the given state, which has nothing
+ *                   to do for the number of microseconds passed. If the frame
+ *                   wasn't drawn, the governor sleeps for as many whole
+ *                   milliseconds of that as it can; this must come last in
+ *                   draw(), so the buttons are read straight afterwards.
+ */
+
+void power_end_frame( gamestate_t p_state, uint32_t p_idle_us )
+{
+  power_stats_t &l_stats = m_stats[p_state < GAMESTATE_MAX ? p_state : GAMESTATE_MAX];
+  uint32_t       l_busy_us, l_sleep_ms;
+
+  l_busy_us = picosystem::time_us() - m_frame_start_us;
+  l_stats.frames++;
+  l_stats.drawn += m_drawing ? 1 : 0;
+  l_stats.elapsed_us += m_delta_us;
+  l_stats.busy_us += l_busy_us;
+
+  /* A frame that's just been drawn goes out to the display without delay. */
+  l_sleep_ms = 0;
+  if ( m_enabled && !m_drawing )
+  {
+    l_sleep_ms = std::min<uint32_t>( p_idle_us / 1000, POWER_MAX_SLEEP_MS );
+  }
+
+#ifdef PICOVADERS_HOST
+  /* The host clock doesn't stretch to fit a sleep, so count what would have */
+  /* been slept out of what was left of this frame.                          */
+  l_stats.idle_us += std::min<uint32_t>( l_sleep_ms * 1000,
+                                         m_delta_us > l_busy_us ? m_delta_us - l_busy_us : 0 );
+#else
+  if ( l_sleep_ms > 0 )
+  {
+    uint32_t l_start_us = picosystem::time_us();
+    picosystem::sleep( l_sleep_ms );
+    l_stats.idle_us += picosystem::time_us() - l_start_us;
+  }
+#endif
+  m_drawing = true;
+  return;
+}
+
+
+/*
+ * power_get_stats - fills in the statistics for a single state.
+ */
+
+void power_get_stats( gamestate_t p_state, power_stats_t &p_stats )
+{
+  p_stats = m_stats[p_state < GAMESTATE_MAX ? p_state : GAMESTATE_MAX];
+  return;
+}
+
+
+/*
+ * power_describe - writes a line per state; how many frames were drawn, and
+ *                  how much of the time was spent busy and asleep.
+ */
+
+void power_describe( FILE *p_stream )
+{
+  fprintf( p_stream, "%-8s %8s %8s %8s %8s %8s\n", "power", "frames", "drawn",
+           "busy", "duty", "asleep" );
+  for ( uint_fast8_t l_state = 0; l_state < POWER_STATES; l_state++ )
+  {
+    const power_stats_t &l_stats = m_stats[l_state];
+    if ( l_stats.frames == 0 )
+    {
+      continue;
+    }
+    fprintf( p_stream, "%-8s %8lu %7.1f%% %6.0fus %7.2f%% %7.2f%%\n",
+             gamestate_name( (gamestate_t)l_state ),
+             (unsigned long)l_stats.frames, 100.0 * l_stats.drawn / l_stats.frames,
+             (double)l_stats.busy_us / l_stats.frames,
+             l_stats.elapsed_us ? 100.0 * l_stats.busy_us / l_stats.elapsed_us : 0.0,
+             l_stats.elapsed_us ? 100.0 * l_stats.idle_us / l_stats.elapsed_us : 0.0 );
+  }
+  fprintf( p_stream, "governor %s\n", m_enabled ? "on" : "off" );
+  return;
+}
+
+
+/* End of file utils/power.cpp */
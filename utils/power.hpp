@@ -0,0 +1,59 @@
+/*
+ * utils/power.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file defines the power governor; most frames, very little on screen
+ * changes, and between timer deadlines nothing does at all. When the current
+ * state says nothing it draws has changed, the governor skips drawing it, and
+ * then sleeps until the state's next deadline rather than spinning.
+ *
+ * The sleep is taken at the very end of draw(), so the SDK reads the buttons
+ * for the next update straight after it, and the time slept is simply part of
+ * the next frame's delta. A freshly drawn frame is never held back by a sleep;
+ * only frames that weren't drawn are followed by one. On the host nothing is
+ * slept; how long would have been is only counted, so that timings and goldens
+ * are unaffected.
+ *
+ * It's off unless asked for; on the device, with PICOVADERS_POWER, or from the
+ * debug console.
+ *
+ * Whether the governor is on or not, every frame's busy time is counted per
+ * state, so the duty cycle can be compared both ways.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+/* System headers. */
+
+#include <cstdio>
+
+
+/* Frames run outside of any state are counted as GAMESTATE_MAX, as for the heap. */
+#define POWER_STATES        ( GAMESTATE_MAX + 1 )
+
+/* A button pressed during a sleep isn't seen until it's over, so keep it well */
+/* under a frame.                                                             */
+#define POWER_MAX_SLEEP_MS  20
+
+struct power_stats_t
+{
+  uint32_t  frames;               /* Frames run in the state ...            */
+  uint32_t  drawn;                /* ... and how many were actually drawn.  */
+  uint64_t  elapsed_us;           /* The time their deltas covered ...      */
+  uint64_t  busy_us;              /* ... how much of it was update and draw */
+  uint64_t  idle_us;              /* ... and how much was spent asleep.     */
+};
+
+void        power_enable( bool );
+bool        power_enabled( void );
+void        power_begin_frame( uint32_t );
+bool        power_should_draw( bool );
+void        power_end_frame( gamestate_t, uint32_t );
+void        power_get_stats( gamestate_t, power_stats_t & );
+void        power_describe( FILE * );
+
+
+/* End of file utils/power.hpp */
@@ -0,0 +1,281 @@
+/*
+ * utils/profiler.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                     for the PicoSystem.
+ *
+ * This file implements the frame profiler; it times the phases of each frame,
+ * keeps a rolling history of frame times, and in DEBUG builds can draw it all
+ * as an overlay on top of the game.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "picovaders.hpp"
+#include "utils/profiler.hpp"
+#include "utils/stack.hpp"
+
+
+/* Module variables. */
+
+static uint32_t     m_phase_start[PROFILE_MAX];
+static uint32_t     m_phase_current[PROFILE_MAX];
+static uint32_t     m_phase_last[PROFILE_MAX];
+static uint32_t     m_history[PROFILE_HISTORY];
+static uint32_t     m_history_index;
+static uint32_t     m_history_count;
+static uint32_t     m_frame_us;
+
+/* On the device the overlay starts visible; on the host, it'd spoil the goldens. */
+#ifdef PICOVADERS_HOST
+static bool         m_overlay_visible = false;
+#else
+static bool         m_overlay_visible = true;
+#endif
+static bool         m_overlay_drawn;
+
+static const char  *m_phase_names[PROFILE_MAX] = {
+  "UPD", "EXP", "BUL", "SCN", "INV", "PLY",
+  "DRW", "CLR", "SHT", "SPR", "TXT", "OVL"
+};
+
+
+/* Functions. */
+
+/*
+ * profiler_begin - marks the start of a phase. Phases can be entered more
+ *                  than once a frame; their times accumulate.
+ */
+
+void profiler_begin( profilephase_t p_phase )
+{
+  m_phase_start[p_phase] = picosystem::time_us();
+}
+
+
+/*
+ * profiler_end - marks the end of a phase, adding its time to the frame.
+ */
+
+void profiler_end( profilephase_t p_phase )
+{
+  m_phase_current[p_phase] += picosystem::time_us() - m_phase_start[p_phase];
+}
+
+
+/*
+ * profiler_frame_end - closes off the current frame; its phase times become
+ *                      the ones reported, and its total goes into the history.
+ */
+
+void profiler_frame_end( void )
+{
+  /* The frame time is the work we did; update and draw, not the overlay. */
+  m_frame_us = m_phase_current[PROFILE_UPDATE] + m_phase_current[PROFILE_DRAW];
+  m_history[m_history_index] = m_frame_us;
+  m_history_index = ( m_history_index + 1 ) % PROFILE_HISTORY;
+  if ( m_history_count < PROFILE_HISTORY )
+  {
+    m_history_count++;
+  }
+
+  /* And start the next frame afresh. */
+  for ( uint_fast8_t l_phase = 0; l_phase < PROFILE_MAX; l_phase++ )
+  {
+    m_phase_last[l_phase] = m_phase_current[l_phase];
+    m_phase_current[l_phase] = 0;
+  }
+}
+
+
+/*
+ * profiler_get_phase - returns the time spent in a phase in the last frame.
+ */
+
+uint32_t profiler_get_phase( profilephase_t p_phase )
+{
+  return m_phase_last[p_phase];
+}
+
+
+/*
+ * profiler_get_current - returns the time spent in a phase so far in the
+ *                        frame that's still running.
+ */
+
+uint32_t profiler_get_current( profilephase_t p_phase )
+{
+  return m_phase_current[p_phase];
+}
+
+
+/*
+ * profiler_get_frame - returns the total time of the last frame.
+ */
+
+uint32_t profiler_get_frame( void )
+{
+  return m_frame_us;
+}
+
+
+/*
+ * profiler_get_stats - works out the min, average, max and 99th percentile
+ *                      frame times, over the recent history.
+ */
+
+void profiler_get_stats( profile_stats_t &p_stats )
+{
+  uint32_t  l_sorted[PROFILE_HISTORY];
+  uint64_t  l_total = 0;
+
+  p_stats = {};
+  p_stats.frames = m_history_count;
+  if ( m_history_count == 0 )
+  {
+    return;
+  }
+
+  /* Order doesn't matter in the history, so we can sort a copy directly. */
+  std::copy( m_history, m_history + m_history_count, l_sorted );
+  std::sort( l_sorted, l_sorted + m_history_count );
+  for ( uint32_t l_index = 0; l_index < m_history_count; l_index++ )
+  {
+    l_total += l_sorted[l_index];
+  }
+
+  p_stats.min_us = l_sorted[0];
+  p_stats.max_us = l_sorted[m_history_count - 1];
+  p_stats.avg_us = l_total / m_history_count;
+  p_stats.p99_us = l_sorted[( m_history_count - 1 ) * 99 / 100];
+}
+
+
+/*
+ * profiler_phase_name - returns the short name of a phase.
+ */
+
+const char *profiler_phase_name( profilephase_t p_phase )
+{
+  return p_phase < PROFILE_MAX ? m_phase_names[p_phase] : "???";
+}
+
+
+/*
+ * profiler_overlay_drawn - returns whether the overlay was drawn last frame;
+ *                          if so, the frame underneath has to be drawn again,
+ *                          to either update the overlay or get rid of it.
+ */
+
+bool profiler_overlay_drawn( void )
+{
+  return m_overlay_drawn;
+}
+
+
+/*
+ * profiler_draw_overlay - draws the last frame's phase times, and a histogram
+ *                         of recent frame times, over the top of the screen.
+ *                         Y toggles it on and off.
+ */
+
+void profiler_draw_overlay( void )
+{
+  profile_stats_t l_stats;
+  uint32_t        l_buckets[PROFILE_BUCKETS] = {}, l_peak = 1, l_bucket;
+  char            l_buffer[40];
+  int32_t         l_y;
+
+  /* Check for the toggle first. */
+  if ( picosystem::pressed( picosystem::Y ) )
+  {
+    m_overlay_visible = !m_overlay_visible;
+  }
+  m_overlay_drawn = m_overlay_visible;
+  if ( !m_overlay_visible )
+  {
+    return;
+  }
+
+  /* Darken a panel for us to draw in. */
+  picosystem::pen( 0, 0, 0, 12 );
+  picosystem::frect( 0, 12, 216, 118 );
+  picosystem::pen( 15, 15, 15 );
+
+  /* Phase timings, three to a line. */
+  l_y = 14;
+  for ( uint_fast8_t l_phase = 0; l_phase < PROFILE_MAX; l_phase += 3 )
+  {
+    snprintf( l_buffer, sizeof( l_buffer ), "%s%5lu %s%5lu %s%5lu",
+              m_phase_names[l_phase], (unsigned long)m_phase_last[l_phase],
+              m_phase_names[l_phase+1], (unsigned long)m_phase_last[l_phase+1],
+              m_phase_names[l_phase+2], (unsigned long)m_phase_last[l_phase+2] );
+    picosystem::text( l_buffer, 2, l_y );
+    l_y += 12;
+  }
+
+  /* The frame time statistics. */
+  profiler_get_stats( l_stats );
+  snprintf( l_buffer, sizeof( l_buffer ), "MIN%6lu AVG%6lu",
+            (unsigned long)l_stats.min_us, (unsigned long)l_stats.avg_us );
+  picosystem::text( l_buffer, 2, l_y );
+  l_y += 12;
+  snprintf( l_buffer, sizeof( l_buffer ), "MAX%6lu P99%6lu",
+            (unsigned long)l_stats.max_us, (unsigned long)l_stats.p99_us );
+  picosystem::text( l_buffer, 2, l_y );
+  l_y += 12;
+
+  /* How deep the stack went, if we're watching it. */
+  if ( stack_enabled() )
+  {
+    snprintf( l_buffer, sizeof( l_buffer ), "STK%6lu%6lu MAX%6lu",
+              (unsigned long)stack_get_last( STACK_UPDATE ),
+              (unsigned long)stack_get_last( STACK_DRAW ),
+              (unsigned long)stack_get_high_water() );
+    picosystem::text( l_buffer, 2, l_y );
+    l_y += 12;
+  }
+
+  /* And the histogram; the budget is split evenly, overruns in the last. */
+  for ( uint32_t l_index = 0; l_index < m_history_count; l_index++ )
+  {
+    l_bucket = m_history[l_index] * PROFILE_BUCKETS / PROFILE_BUDGET_US;
+    if ( l_bucket >= PROFILE_BUCKETS )
+    {
+      l_bucket = PROFILE_BUCKETS - 1;
+    }
+    if ( ++l_buckets[l_bucket] > l_peak )
+    {
+      l_peak = l_buckets[l_bucket];
+    }
+  }
+  for ( uint_fast8_t l_index = 0; l_index < PROFILE_BUCKETS; l_index++ )
+  {
+    int32_t l_height = l_buckets[l_index] * 24 / l_peak;
+    if ( l_index == PROFILE_BUCKETS - 1 )
+    {
+      picosystem::pen( 15, 4, 4 );
+    }
+    else
+    {
+      picosystem::pen( 4, 15, 4 );
+    }
+    if ( l_height > 0 )
+    {
+      picosystem::frect( 2 + l_index * 6, l_y + 26 - l_height, 5, l_height );
+    }
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/* End of file utils/profiler.cpp */
@@ -0,0 +1,71 @@
+/*
+ * utils/profiler.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                     for the PicoSystem.
+ *
+ * This file defines the frame profiler; it times the phases of each frame,
+ * keeps a rolling history of frame times, and in DEBUG builds can draw it all
+ * as an overlay on top of the game.
+ *
+ * The PROFILE_ macros compile away to nothing unless PICOVADERS_PROFILE is
+ * defined, which DEBUG builds do.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#if defined(DEBUG) && !defined(PICOVADERS_PROFILE)
+#define PICOVADERS_PROFILE 1
+#endif
+
+#define PROFILE_HISTORY     128
+#define PROFILE_BUCKETS     20
+#define PROFILE_BUDGET_US   25000
+
+typedef enum
+{
+  PROFILE_UPDATE,
+  PROFILE_EXPLOSIONS,
+  PROFILE_BULLET,
+  PROFILE_SHEET_SCAN,
+  PROFILE_INVADERS,
+  PROFILE_PLAYER,
+  PROFILE_DRAW,
+  PROFILE_DRAW_CLEAR,
+  PROFILE_DRAW_SHEET,
+  PROFILE_DRAW_SPRITES,
+  PROFILE_DRAW_TEXT,
+  PROFILE_OVERLAY,
+  PROFILE_MAX
+} profilephase_t;
+
+struct profile_stats_t
+{
+  uint32_t  min_us, avg_us, max_us, p99_us;
+  uint32_t  frames;
+};
+
+void        profiler_begin( profilephase_t );
+void        profiler_end( profilephase_t );
+void        profiler_frame_end( void );
+uint32_t    profiler_get_phase( profilephase_t );
+uint32_t    profiler_get_current( profilephase_t );
+uint32_t    profiler_get_frame( void );
+void        profiler_get_stats( profile_stats_t & );
+const char *profiler_phase_name( profilephase_t );
+bool        profiler_overlay_drawn( void );
+void        profiler_draw_overlay( void );
+
+#ifdef PICOVADERS_PROFILE
+#define PROFILE_BEGIN(p)    profiler_begin( p )
+#define PROFILE_END(p)      profiler_end( p )
+#define PROFILE_FRAME_END() profiler_frame_end()
+#else
+#define PROFILE_BEGIN(p)
+#define PROFILE_END(p)
+#define PROFILE_FRAME_END()
+#endif
+
+
+/* End of file utils/profiler.hpp */
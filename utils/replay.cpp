@@ -0,0 +1,370 @@
+/*
+ * utils/replay.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file implements the InputRecorder and InputPlayer classes; between them,
+ * they capture the buttons and frame delta of every frame in a compact run
+ * length format, and feed them back later to reproduce a game exactly.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <string.h>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/replay.hpp"
+
+
+/* Module variables. */
+
+static const uint32_t m_button_map[] = {
+  picosystem::UP, picosystem::DOWN, picosystem::LEFT, picosystem::RIGHT,
+  picosystem::A, picosystem::B, picosystem::X, picosystem::Y
+};
+
+
+/* Functions. */
+
+/*
+ * replay_buttons_from_io - packs the SDK's (active low) io state into the
+ *                          button byte we record.
+ */
+
+uint8_t replay_buttons_from_io( uint32_t p_io )
+{
+  uint8_t l_buttons = 0;
+
+  for ( uint_fast8_t l_index = 0; l_index < 8; l_index++ )
+  {
+    if ( !( p_io & ( 1U << m_button_map[l_index] ) ) )
+    {
+      l_buttons |= 1U << l_index;
+    }
+  }
+  return l_buttons;
+}
+
+
+/*
+ * replay_io_from_buttons - unpacks a recorded button byte back into io state.
+ */
+
+uint32_t replay_io_from_buttons( uint8_t p_buttons )
+{
+  uint32_t l_io = 0xffffffff;
+
+  for ( uint_fast8_t l_index = 0; l_index < 8; l_index++ )
+  {
+    if ( p_buttons & ( 1U << l_index ) )
+    {
+      l_io &= ~( 1U << m_button_map[l_index] );
+    }
+  }
+  return l_io;
+}
+
+
+/*
+ * InputRecorder constructor - records into the buffer provided; the caller
+ *                             owns it, and it must outlive us.
+ */
+
+InputRecorder::InputRecorder( uint8_t *p_buffer, uint32_t p_capacity )
+{
+  /* Remember where we're writing to. */
+  this->m_buffer = p_buffer;
+  this->m_capacity = p_capacity;
+  this->m_length = 0;
+  this->m_frames = 0;
+  this->m_run_count = 0;
+  this->m_overflow = false;
+
+  /* Start with the magic header, if it fits. */
+  if ( p_capacity < REPLAY_MAGIC_LEN )
+  {
+    this->m_overflow = true;
+    return;
+  }
+  memcpy( this->m_buffer, REPLAY_MAGIC, REPLAY_MAGIC_LEN );
+  this->m_length = REPLAY_MAGIC_LEN;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * InputRecorder destructor - tidy up any allocated resources.
+ */
+
+InputRecorder::~InputRecorder()
+{
+  /* All done. */
+  return;
+}
+
+
+/*
+ * put_varint - appends a value in 7-bit chunks, low first; returns false if
+ *              the buffer runs out.
+ */
+
+bool InputRecorder::put_varint( uint32_t p_value )
+{
+  do
+  {
+    if ( this->m_length >= this->m_capacity )
+    {
+      return false;
+    }
+    this->m_buffer[this->m_length++] = ( p_value & 0x7f ) | ( p_value > 0x7f ? 0x80 : 0 );
+    p_value >>= 7;
+  } while ( p_value != 0 );
+
+  return true;
+}
+
+
+/*
+ * record - adds a frame to the recording; it's only written out when the
+ *          run of identical frames it belongs to ends.
+ */
+
+void InputRecorder::record( uint8_t p_buttons, uint32_t p_delta )
+{
+  /* Once we've run out of space, we stop; a partial recording is still good. */
+  if ( this->m_overflow )
+  {
+    return;
+  }
+
+  /* Extend the current run if we can, otherwise write it out first. */
+  if ( this->m_run_count > 0 &&
+       ( this->m_run_buttons != p_buttons || this->m_run_delta != p_delta ) )
+  {
+    this->finish();
+  }
+  if ( this->m_overflow )
+  {
+    return;
+  }
+  this->m_run_buttons = p_buttons;
+  this->m_run_delta = p_delta;
+  this->m_run_count++;
+  this->m_frames++;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * finish - writes out any pending run, so the buffer holds a complete
+ *          recording; returns its length in bytes. Recording can carry on
+ *          afterwards.
+ */
+
+uint32_t InputRecorder::finish( void )
+{
+  uint32_t l_length = this->m_length;
+  bool     l_written = false;
+
+  /* Write out the pending run, if there is one. */
+  if ( this->m_run_count > 0 && !this->m_overflow )
+  {
+    if ( this->m_length < this->m_capacity )
+    {
+      this->m_buffer[this->m_length++] = this->m_run_buttons;
+      l_written = this->put_varint( this->m_run_delta ) &&
+                  this->put_varint( this->m_run_count );
+    }
+
+    /* If it didn't fit, drop the partial run so what we have is still valid. */
+    if ( !l_written )
+    {
+      this->m_length = l_length;
+      this->m_frames -= this->m_run_count;
+      this->m_overflow = true;
+    }
+    this->m_run_count = 0;
+  }
+
+  /* All done. */
+  return this->m_length;
+}
+
+
+/*
+ * get_frames - returns how many frames have been recorded.
+ */
+
+uint32_t InputRecorder::get_frames( void )
+{
+  return this->m_frames;
+}
+
+
+/*
+ * overflowed - returns true if the recording ran out of space.
+ */
+
+bool InputRecorder::overflowed( void )
+{
+  return this->m_overflow;
+}
+
+
+/*
+ * InputPlayer constructor - plays back from the buffer provided; the caller
+ *                           owns it, and it must outlive us.
+ */
+
+InputPlayer::InputPlayer( const uint8_t *p_buffer, uint32_t p_length )
+{
+  /* Remember where we're reading from. */
+  this->m_buffer = p_buffer;
+  this->m_length = p_length;
+  this->m_offset = REPLAY_MAGIC_LEN;
+  this->m_frames = 0;
+  this->m_run_count = 0;
+  this->m_last_io = 0xffffffff;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * InputPlayer destructor - tidy up any allocated resources.
+ */
+
+InputPlayer::~InputPlayer()
+{
+  /* All done. */
+  return;
+}
+
+
+/*
+ * valid - checks that the buffer looks like a recording.
+ */
+
+bool InputPlayer::valid( void )
+{
+  return this->m_length >= REPLAY_MAGIC_LEN &&
+         memcmp( this->m_buffer, REPLAY_MAGIC, REPLAY_MAGIC_LEN ) == 0;
+}
+
+
+/*
+ * get_varint - reads a value written by InputRecorder::put_varint; returns
+ *              false if the buffer runs out first.
+ */
+
+bool InputPlayer::get_varint( uint32_t &p_value )
+{
+  uint_fast8_t l_shift = 0;
+
+  p_value = 0;
+  do
+  {
+    if ( this->m_offset >= this->m_length || l_shift > 28 )
+    {
+      return false;
+    }
+    p_value |= (uint32_t)( this->m_buffer[this->m_offset] & 0x7f ) << l_shift;
+    l_shift += 7;
+  } while ( this->m_buffer[this->m_offset++] & 0x80 );
+
+  return true;
+}
+
+
+/*
+ * next - fetches the buttons and delta for the next frame; returns false
+ *        once the recording has run out.
+ */
+
+bool InputPlayer::next( uint8_t &p_buttons, uint32_t &p_delta )
+{
+  /* Move on to the next run, if this one is used up. */
+  while ( this->m_run_count == 0 )
+  {
+    if ( !this->valid() || this->m_offset >= this->m_length )
+    {
+      return false;
+    }
+    this->m_run_buttons = this->m_buffer[this->m_offset++];
+    if ( !this->get_varint( this->m_run_delta ) ||
+         !this->get_varint( this->m_run_count ) )
+    {
+      this->m_offset = this->m_length;
+      this->m_run_count = 0;
+      return false;
+    }
+  }
+
+  /* And take a frame from it. */
+  p_buttons = this->m_run_buttons;
+  p_delta = this->m_run_delta;
+  this->m_run_count--;
+  this->m_frames++;
+  return true;
+}
+
+
+/*
+ * apply - plays the next frame; the SDK's button state is replaced with the
+ *         recorded one, as is the delta passed in. Returns false, and leaves
+ *         everything alone, once the recording has run out.
+ */
+
+bool InputPlayer::apply( uint32_t &p_delta )
+{
+  uint8_t l_buttons;
+
+  if ( !this->next( l_buttons, p_delta ) )
+  {
+    return false;
+  }
+
+  /* pressed() needs the previous frame too, so keep track of it ourselves. */
+  picosystem::_lio = this->m_last_io;
+  picosystem::_io = this->m_last_io = replay_io_from_buttons( l_buttons );
+  return true;
+}
+
+
+/*
+ * get_frames - returns how many frames have been played.
+ */
+
+uint32_t InputPlayer::get_frames( void )
+{
+  return this->m_frames;
+}
+
+
+/*
+ * count_frames - returns the total number of frames in the recording,
+ *                without disturbing playback.
+ */
+
+uint32_t InputPlayer::count_frames( void )
+{
+  InputPlayer l_scan( this->m_buffer, this->m_length );
+  uint8_t     l_buttons;
+  uint32_t    l_delta;
+
+  while ( l_scan.next( l_buttons, l_delta ) );
+  return l_scan.get_frames();
+}
+
+
+/* End of file utils/replay.cpp */
@@ -0,0 +1,85 @@
+/*
+ * utils/replay.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                   for the PicoSystem.
+ *
+ * This file defines the InputRecorder and InputPlayer classes; between them,
+ * they capture the buttons and frame delta of every frame in a compact run
+ * length format, and feed them back later to reproduce a game exactly.
+ *
+ * Recordings start with REPLAY_MAGIC, followed by runs of identical frames;
+ * each run is a button byte, then the delta and the run length as varints.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#define REPLAY_MAGIC      "PVR1"
+#define REPLAY_MAGIC_LEN  4
+
+/* Button bits, as stored in a recording. */
+
+#define REPLAY_UP         0x01
+#define REPLAY_DOWN       0x02
+#define REPLAY_LEFT       0x04
+#define REPLAY_RIGHT      0x08
+#define REPLAY_A          0x10
+#define REPLAY_B          0x20
+#define REPLAY_X          0x40
+#define REPLAY_Y          0x80
+
+uint8_t       replay_buttons_from_io( uint32_t );
+uint32_t      replay_io_from_buttons( uint8_t );
+
+class InputRecorder
+{
+private:
+  uint8_t    *m_buffer;
+  uint32_t    m_capacity;
+  uint32_t    m_length;
+  uint32_t    m_frames;
+  bool        m_overflow;
+  uint8_t     m_run_buttons;
+  uint32_t    m_run_delta;
+  uint32_t    m_run_count;
+
+  bool        put_varint( uint32_t );
+
+public:
+              InputRecorder( uint8_t *, uint32_t );
+             ~InputRecorder();
+
+  void        record( uint8_t, uint32_t );
+  uint32_t    finish( void );
+  uint32_t    get_frames( void );
+  bool        overflowed( void );
+};
+
+class InputPlayer
+{
+private:
+  const uint8_t *m_buffer;
+  uint32_t    m_length;
+  uint32_t    m_offset;
+  uint32_t    m_frames;
+  uint8_t     m_run_buttons;
+  uint32_t    m_run_delta;
+  uint32_t    m_run_count;
+  uint32_t    m_last_io;
+
+  bool        get_varint( uint32_t & );
+
+public:
+              InputPlayer( const uint8_t *, uint32_t );
+             ~InputPlayer();
+
+  bool        valid( void );
+  bool        next( uint8_t &, uint32_t & );
+  bool        apply( uint32_t & );
+  uint32_t    get_frames( void );
+  uint32_t    count_frames( void );
+};
+
+
+/* End of file utils/replay.hpp */
@@ -0,0 +1,427 @@
+/*
+ * utils/scheduler.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                      for the PicoSystem.
+ *
+ * This file implements the TickScheduler class; a handful of periodic timers,
+ * advanced together and handed out in deadline order.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <algorithm>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/scheduler.hpp"
+
+
+/* Functions. */
+
+/*
+ * set_subticks - sets a timer's period from microseconds over a divisor; the
+ *                whole subticks, and what's left over. It's never zero.
+ */
+
+static void set_subticks( scheduler_timer_t &p_timer, uint32_t p_period_us, uint32_t p_divisor )
+{
+  uint64_t l_period;
+
+  p_timer.divisor = std::max<uint32_t>( p_divisor, 1 );
+  l_period = (uint64_t)p_period_us * SCHEDULER_SUBTICKS;
+  p_timer.period = (uint32_t)std::min<uint64_t>( l_period / p_timer.divisor, UINT32_MAX );
+  p_timer.remainder = p_timer.period == UINT32_MAX ? 0 : l_period % p_timer.divisor;
+  if ( p_timer.period == 0 )
+  {
+    p_timer.period = 1;
+    p_timer.remainder = 0;
+  }
+  p_timer.carry = 0;
+}
+
+
+/*
+ * deadline_at - works out where a timer's deadline will be after a number of
+ *               periods, carrying the fractions along.
+ */
+
+static uint64_t deadline_at( const scheduler_timer_t &p_timer, uint64_t p_periods )
+{
+  return p_timer.deadline + p_periods * p_timer.period +
+         ( p_timer.carry + p_periods * p_timer.remainder ) / p_timer.divisor;
+}
+
+
+/*
+ * move_on - moves a timer's deadline on by a number of periods.
+ */
+
+static void move_on( scheduler_timer_t &p_timer, uint64_t p_periods )
+{
+  uint64_t l_carry;
+
+  l_carry = p_timer.carry + p_periods * p_timer.remainder;
+  p_timer.deadline += p_periods * p_timer.period + l_carry / p_timer.divisor;
+  p_timer.carry = l_carry % p_timer.divisor;
+}
+
+
+/*
+ * periods_before - counts how many of a timer's deadlines, from the next one
+ *                  on, fall before the given time.
+ */
+
+static uint64_t periods_before( const scheduler_timer_t &p_timer, uint64_t p_bound )
+{
+  uint64_t l_periods;
+
+  if ( p_timer.deadline >= p_bound )
+  {
+    return 0;
+  }
+
+  /* Going by whole periods can only overcount, as the fractions make the */
+  /* deadlines later; so trim off any that don't really make it.          */
+  l_periods = ( p_bound - 1 - p_timer.deadline ) / p_timer.period + 1;
+  while ( l_periods > 1 && deadline_at( p_timer, l_periods - 1 ) >= p_bound )
+  {
+    l_periods--;
+  }
+  return l_periods;
+}
+
+
+/*
+ * constructor - starts with no timers, at time zero.
+ */
+
+TickScheduler::TickScheduler( void )
+{
+  this->m_time = 0;
+  this->m_timer_count = 0;
+  this->m_catchup_limit = 0;
+  this->m_catchup = 0;
+  this->m_skipped = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * destructor - tidy up any allocated resources.
+ */
+
+TickScheduler::~TickScheduler()
+{
+  /* All done. */
+  return;
+}
+
+
+/*
+ * add - adds a timer with the given period, in microseconds over an optional
+ *       divisor; returns its ID, which is simply the order it was added in.
+ */
+
+uint_fast8_t TickScheduler::add( uint32_t p_period_us, uint32_t p_divisor )
+{
+  scheduler_timer_t *l_timer;
+
+  if ( this->m_timer_count >= SCHEDULER_MAX_TIMERS )
+  {
+    return SCHEDULER_NONE;
+  }
+
+  l_timer = &this->m_timers[this->m_timer_count];
+  set_subticks( *l_timer, p_period_us, p_divisor );
+  l_timer->deadline = this->m_time + l_timer->period;
+  l_timer->fired = 0;
+  l_timer->count = 0;
+
+  /* All done. */
+  return this->m_timer_count++;
+}
+
+
+/*
+ * advance - moves time on for every timer at once, in microseconds.
+ */
+
+void TickScheduler::advance( uint32_t p_delta_us )
+{
+  this->m_time += (uint64_t)p_delta_us * SCHEDULER_SUBTICKS;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * next - fires the timer with the earliest deadline that's been reached, and
+ *        returns its ID; returns SCHEDULER_NONE when nothing else is due.
+ *        Timers that have reached the catch-up limit are moved on instead.
+ */
+
+uint_fast8_t TickScheduler::next( void )
+{
+  uint_fast8_t  l_index, l_next = SCHEDULER_NONE;
+  uint64_t      l_missed;
+
+  for ( l_index = 0; l_index < this->m_timer_count; l_index++ )
+  {
+    scheduler_timer_t &l_timer = this->m_timers[l_index];
+
+    /* A timer is due once its deadline is reached. */
+    if ( l_timer.deadline > this->m_time )
+    {
+      continue;
+    }
+
+    /* If it's had as many goes as it's allowed, skip the rest in one go. */
+    if ( this->m_catchup_limit > 0 && l_timer.fired >= this->m_catchup_limit )
+    {
+      l_missed = periods_before( l_timer, this->m_time + 1 );
+      move_on( l_timer, l_missed );
+      this->m_skipped += l_missed;
+      continue;
+    }
+
+    if ( l_next == SCHEDULER_NONE || l_timer.deadline < this->m_timers[l_next].deadline )
+    {
+      l_next = l_index;
+    }
+  }
+
+  /* Fire the winner, if there is one; its next deadline is a period on. */
+  if ( l_next != SCHEDULER_NONE )
+  {
+    scheduler_timer_t &l_timer = this->m_timers[l_next];
+    move_on( l_timer, 1 );
+    l_timer.count++;
+    if ( ++l_timer.fired > 1 )
+    {
+      this->m_catchup++;
+    }
+  }
+
+  /* All done. */
+  return l_next;
+}
+
+
+/*
+ * take_run - fires a timer again for as long as it would keep coming out of
+ *            next(), ahead of every other timer; returns how many more times
+ *            it fired. Only for a timer that's just been handed out, and
+ *            whose work doesn't move any other timer.
+ */
+
+uint32_t TickScheduler::take_run( uint_fast8_t p_timer )
+{
+  uint_fast8_t  l_index;
+  uint64_t      l_bound, l_deadline;
+  uint32_t      l_runs;
+
+  if ( p_timer >= this->m_timer_count )
+  {
+    return 0;
+  }
+  scheduler_timer_t &l_timer = this->m_timers[p_timer];
+
+  /* Its deadlines have to have been reached, and be ahead of every other  */
+  /* timer that's going to fire; ties go to the lower ID, as in next().    */
+  l_bound = this->m_time + 1;
+  for ( l_index = 0; l_index < this->m_timer_count; l_index++ )
+  {
+    const scheduler_timer_t &l_other = this->m_timers[l_index];
+    if ( l_index == p_timer ||
+         ( this->m_catchup_limit > 0 && l_other.fired >= this->m_catchup_limit ) )
+    {
+      continue;
+    }
+    l_deadline = l_other.deadline + ( l_index > p_timer ? 1 : 0 );
+    l_bound = std::min( l_bound, l_deadline );
+  }
+
+  /* So, how many of its deadlines fall before that? */
+  l_runs = periods_before( l_timer, l_bound );
+
+  /* The catch-up limit still applies; next() will skip whatever's left. */
+  if ( this->m_catchup_limit > 0 )
+  {
+    l_runs = l_timer.fired < this->m_catchup_limit ?
+             std::min<uint32_t>( l_runs, this->m_catchup_limit - l_timer.fired ) : 0;
+  }
+
+  move_on( l_timer, l_runs );
+  l_timer.count += l_runs;
+  l_timer.fired += l_runs;
+  this->m_catchup += l_runs;
+
+  /* All done. */
+  return l_runs;
+}
+
+
+/*
+ * reset_counts - starts counting firings, catch-up and skips again from zero;
+ *                the catch-up limit applies between resets.
+ */
+
+void TickScheduler::reset_counts( void )
+{
+  this->m_catchup = 0;
+  this->m_skipped = 0;
+  for ( uint_fast8_t l_index = 0; l_index < this->m_timer_count; l_index++ )
+  {
+    this->m_timers[l_index].fired = 0;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * set_period - changes a timer's period, in microseconds over an optional
+ *              divisor. The time left to its next deadline is scaled to the
+ *              new period, so it keeps its phase; setting the same period
+ *              again changes nothing at all.
+ */
+
+void TickScheduler::set_period( uint_fast8_t p_timer, uint32_t p_period_us, uint32_t p_divisor )
+{
+  scheduler_timer_t l_old;
+
+  if ( p_timer >= this->m_timer_count )
+  {
+    return;
+  }
+  scheduler_timer_t &l_timer = this->m_timers[p_timer];
+
+  l_old = l_timer;
+  set_subticks( l_timer, p_period_us, p_divisor );
+  if ( l_timer.period == l_old.period && l_timer.remainder == l_old.remainder &&
+       l_timer.divisor == l_old.divisor )
+  {
+    l_timer.carry = l_old.carry;
+    return;
+  }
+
+  /* A timer that's already due stays due; otherwise, rescale what's left. */
+  /* Rounding to the nearest subtick keeps repeated retiming from drifting. */
+  if ( l_timer.deadline > this->m_time )
+  {
+    l_timer.deadline = this->m_time +
+      ( std::min<uint64_t>( l_timer.deadline - this->m_time, l_old.period ) * l_timer.period +
+        l_old.period / 2 ) / l_old.period;
+  }
+}
+
+
+/*
+ * get_period - returns a timer's period, to the nearest microsecond.
+ */
+
+uint32_t TickScheduler::get_period( uint_fast8_t p_timer )
+{
+  if ( p_timer >= this->m_timer_count )
+  {
+    return 0;
+  }
+  return ( this->m_timers[p_timer].period + SCHEDULER_SUBTICKS / 2 ) / SCHEDULER_SUBTICKS;
+}
+
+
+/*
+ * get_count - returns how many times a timer has fired in all; useful for
+ *             things like picking which animation frame to use.
+ */
+
+uint32_t TickScheduler::get_count( uint_fast8_t p_timer )
+{
+  return p_timer < this->m_timer_count ? this->m_timers[p_timer].count : 0;
+}
+
+
+/*
+ * get_fired - returns how many times a timer has fired since the last reset.
+ */
+
+uint32_t TickScheduler::get_fired( uint_fast8_t p_timer )
+{
+  return p_timer < this->m_timer_count ? this->m_timers[p_timer].fired : 0;
+}
+
+
+/*
+ * get_time - returns how far time has been advanced, in microseconds.
+ */
+
+uint64_t TickScheduler::get_time( void )
+{
+  return this->m_time / SCHEDULER_SUBTICKS;
+}
+
+
+/*
+ * get_time_to_next - returns how long it is until the next deadline, in whole
+ *                    microseconds (rounded up); zero if a timer's already due.
+ */
+
+uint32_t TickScheduler::get_time_to_next( void )
+{
+  uint64_t l_deadline = UINT64_MAX;
+
+  for ( uint_fast8_t l_index = 0; l_index < this->m_timer_count; l_index++ )
+  {
+    l_deadline = std::min( l_deadline, this->m_timers[l_index].deadline );
+  }
+  if ( l_deadline <= this->m_time )
+  {
+    return 0;
+  }
+  return (uint32_t)std::min<uint64_t>( ( l_deadline - this->m_time + SCHEDULER_SUBTICKS - 1 ) /
+                                       SCHEDULER_SUBTICKS, UINT32_MAX );
+}
+
+
+/*
+ * set_catchup_limit - caps how many times any one timer can fire between
+ *                     resets; zero (the default) is no limit.
+ */
+
+void TickScheduler::set_catchup_limit( uint16_t p_limit )
+{
+  this->m_catchup_limit = p_limit;
+}
+
+
+/*
+ * get_catchup - returns how many catch-up firings (those after the first, for
+ *               each timer) there have been since the last reset.
+ */
+
+uint32_t TickScheduler::get_catchup( void )
+{
+  return this->m_catchup;
+}
+
+
+/*
+ * get_skipped - returns how many firings have been skipped over since the last
+ *               reset, because of the catch-up limit.
+ */
+
+uint32_t TickScheduler::get_skipped( void )
+{
+  return this->m_skipped;
+}
+
+
+/* End of file utils/scheduler.cpp */
@@ -0,0 +1,82 @@
+/*
+ * utils/scheduler.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                      for the PicoSystem.
+ *
+ * This file defines the TickScheduler class; a handful of periodic timers,
+ * all advanced together by a single delta. Due timers are handed out one at a
+ * time in deadline order (ties going to the timer added first), so the caller
+ * dispatches them with a simple loop.
+ *
+ * Time is kept in 256ths of a microsecond, so a period can be a fraction (a
+ * number of microseconds over a divisor, such as 1000000/60). Whatever part
+ * of a period is finer than that is carried from one deadline to the next, so
+ * every deadline is exactly where it should be, however long it runs.
+ * Changing a period keeps the timer's phase; if it was half way to its next
+ * deadline, it still is, at the new rate.
+ *
+ * Time can be advanced in several steps between resets of the counts (once a
+ * frame, say); every firing beyond the first for a timer since the last reset
+ * is catch-up work, which is counted. It can also be capped, in which case the
+ * excess firings are skipped over rather than run.
+ *
+ * A timer whose work can be done in bulk can take its whole run of firings at
+ * once; that is, every further time it would have been handed out before any
+ * other timer.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#define SCHEDULER_MAX_TIMERS  4
+#define SCHEDULER_NONE        0xff
+#define SCHEDULER_SUBTICKS    256           /* Per microsecond. */
+
+#define SCHEDULER_MS(ms)      ( (uint32_t)( ms ) * 1000 )
+
+struct scheduler_timer_t
+{
+  uint64_t    deadline;       /* When it next fires, in subticks. */
+  uint32_t    period;         /* Also in subticks, ...            */
+  uint32_t    remainder;      /* ... plus remainder / divisor.    */
+  uint32_t    divisor;
+  uint32_t    carry;          /* The remainders built up so far.  */
+  uint32_t    fired;          /* Firings since the counts were reset. */
+  uint32_t    count;
+};
+
+class TickScheduler
+{
+private:
+  uint64_t          m_time;
+  uint_fast8_t      m_timer_count;
+  uint16_t          m_catchup_limit;
+  uint32_t          m_catchup;
+  uint32_t          m_skipped;
+  scheduler_timer_t m_timers[SCHEDULER_MAX_TIMERS];
+
+public:
+                    TickScheduler( void );
+                   ~TickScheduler();
+
+  uint_fast8_t      add( uint32_t, uint32_t = 1 );
+  void              advance( uint32_t );
+  uint_fast8_t      next( void );
+  uint32_t          take_run( uint_fast8_t );
+  void              reset_counts( void );
+
+  void              set_period( uint_fast8_t, uint32_t, uint32_t = 1 );
+  uint32_t          get_period( uint_fast8_t );
+  uint32_t          get_count( uint_fast8_t );
+  uint32_t          get_fired( uint_fast8_t );
+  uint64_t          get_time( void );
+  uint32_t          get_time_to_next( void );
+
+  void              set_catchup_limit( uint16_t );
+  uint32_t          get_catchup( void );
+  uint32_t          get_skipped( void );
+};
+
+
+/* End of file utils/scheduler.hpp */
@@ -0,0 +1,298 @@
+/*
+ * utils/stack.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file implements the stack meter; unused stack is painted with a known
+ * pattern, and after a phase of the frame has run we look for how far down
+ * the pattern was disturbed. That gives the deepest the stack has ever been,
+ * measured from its top, for every state and phase.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#ifdef PICOVADERS_HOST
+#include <pthread.h>
+#endif
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "picovaders.hpp"
+#include "utils/stack.hpp"
+
+
+/* The stacks for each core, as laid out by the SDK's linker script. */
+
+#ifndef PICOVADERS_HOST
+extern "C" uint8_t __StackBottom, __StackTop, __StackOneBottom, __StackOneTop;
+#endif
+
+
+/* Module variables. */
+
+static bool           m_enabled;
+static bool           m_have_region;
+static stack_region_t m_region;
+static uint8_t       *m_painted;
+static uint32_t       m_last[STACK_PHASE_MAX];
+static uint32_t       m_max[GAMESTATE_MAX+1][STACK_PHASE_MAX];
+static uint32_t       m_high_water;
+static uint32_t       m_base;
+
+
+/* Functions. */
+
+/*
+ * stack_current_region - finds the stack of the calling thread (or core);
+ *                        returns false if it can't be determined.
+ */
+
+bool stack_current_region( stack_region_t &p_region )
+{
+#ifdef PICOVADERS_HOST
+  pthread_attr_t  l_attr;
+  void           *l_base;
+  size_t          l_size;
+
+  /* The thread library knows where it put us. */
+  if ( pthread_getattr_np( pthread_self(), &l_attr ) != 0 )
+  {
+    return false;
+  }
+  pthread_attr_getstack( &l_attr, &l_base, &l_size );
+  pthread_attr_destroy( &l_attr );
+  p_region.bottom = (uint8_t *)l_base;
+  p_region.top = (uint8_t *)l_base + l_size;
+  return true;
+#else
+  uint8_t *l_frame = (uint8_t *)__builtin_frame_address( 0 );
+
+  /* Just work out which core's stack we're running on. */
+  if ( l_frame >= &__StackBottom && l_frame < &__StackTop )
+  {
+    p_region.bottom = &__StackBottom;
+    p_region.top = &__StackTop;
+    return true;
+  }
+  return stack_core1_region( p_region );
+#endif
+}
+
+
+/*
+ * stack_core1_region - finds the second core's stack, which should be painted
+ *                      before anything is launched on it; there isn't one on
+ *                      the host, where each thread has its own.
+ */
+
+bool stack_core1_region( stack_region_t &p_region )
+{
+#ifdef PICOVADERS_HOST
+  (void)p_region;
+  return false;
+#else
+  p_region.bottom = &__StackOneBottom;
+  p_region.top = &__StackOneTop;
+  return true;
+#endif
+}
+
+
+/*
+ * stack_paint - paints the unused part of a stack with our pattern, leaving a
+ *               margin below the caller's frame alone. On the host, only a
+ *               window is painted. Returns the lowest address painted, which
+ *               stack_measure needs; nullptr if nothing could be.
+ */
+
+uint8_t *stack_paint( const stack_region_t &p_region )
+{
+  uint8_t            *l_frame = (uint8_t *)__builtin_frame_address( 0 );
+  uint8_t            *l_low, *l_high;
+  volatile uint32_t  *l_word;
+
+  /* If we're not on this stack, the whole thing is fair game. */
+  l_high = p_region.top;
+  if ( l_frame >= p_region.bottom && l_frame < p_region.top )
+  {
+    l_high = l_frame - STACK_MARGIN;
+  }
+  l_low = p_region.bottom;
+#ifdef PICOVADERS_HOST
+  if ( l_high - l_low > STACK_HOST_WINDOW )
+  {
+    l_low = l_high - STACK_HOST_WINDOW;
+  }
+#endif
+
+  /* Align ourselves to whole words, and paint. */
+  l_low = (uint8_t *)( ( (uintptr_t)l_low + 3 ) & ~(uintptr_t)3 );
+  l_high = (uint8_t *)( (uintptr_t)l_high & ~(uintptr_t)3 );
+  if ( l_high <= l_low )
+  {
+    return nullptr;
+  }
+  for ( l_word = (volatile uint32_t *)l_low; l_word < (volatile uint32_t *)l_high; l_word++ )
+  {
+    *l_word = STACK_PATTERN;
+  }
+
+  /* All done. */
+  return l_low;
+}
+
+
+/*
+ * stack_measure - scans up from the lowest painted address for the first
+ *                 word that's been disturbed, and returns how far that is
+ *                 from the top of the stack.
+ */
+
+uint32_t stack_measure( const stack_region_t &p_region, const uint8_t *p_painted )
+{
+  const volatile uint32_t *l_word = (const volatile uint32_t *)p_painted;
+
+  if ( p_painted == nullptr )
+  {
+    return 0;
+  }
+  while ( (const uint8_t *)l_word < p_region.top && *l_word == STACK_PATTERN )
+  {
+    l_word++;
+  }
+  return p_region.top - (const uint8_t *)l_word;
+}
+
+
+/*
+ * stack_enable - turns measurement on or off; painting the stack costs time,
+ *                so it only happens when asked for.
+ */
+
+void stack_enable( bool p_enabled )
+{
+  m_enabled = p_enabled;
+  if ( m_enabled && !m_have_region )
+  {
+    m_have_region = stack_current_region( m_region );
+  }
+  return;
+}
+
+
+/*
+ * stack_enabled - returns whether measurement is on (and possible).
+ */
+
+bool stack_enabled( void )
+{
+  return m_enabled && m_have_region;
+}
+
+
+/*
+ * stack_begin - paints the stack, ready to measure the phase about to run.
+ */
+
+void stack_begin( void )
+{
+  if ( stack_enabled() )
+  {
+    m_base = m_region.top - (uint8_t *)__builtin_frame_address( 0 );
+    m_painted = stack_paint( m_region );
+  }
+  return;
+}
+
+
+/*
+ * stack_end - measures how deep the phase that just ran went, and keeps it
+ *             against the state and phase.
+ */
+
+void stack_end( gamestate_t p_state, stackphase_t p_phase )
+{
+  uint32_t l_depth;
+
+  if ( !stack_enabled() || m_painted == nullptr )
+  {
+    return;
+  }
+
+  /* Measure, and keep track of the worst. */
+  l_depth = stack_measure( m_region, m_painted );
+  m_last[p_phase] = l_depth;
+  if ( p_state > GAMESTATE_MAX )
+  {
+    p_state = GAMESTATE_MAX;
+  }
+  if ( l_depth > m_max[p_state][p_phase] )
+  {
+    m_max[p_state][p_phase] = l_depth;
+  }
+  if ( l_depth > m_high_water )
+  {
+    m_high_water = l_depth;
+  }
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * stack_get_last - returns the depth the given phase reached last time.
+ */
+
+uint32_t stack_get_last( stackphase_t p_phase )
+{
+  return m_last[p_phase];
+}
+
+
+/*
+ * stack_get_max - returns the deepest the given state and phase has gone.
+ */
+
+uint32_t stack_get_max( gamestate_t p_state, stackphase_t p_phase )
+{
+  return m_max[p_state > GAMESTATE_MAX ? GAMESTATE_MAX : p_state][p_phase];
+}
+
+
+/*
+ * stack_get_high_water - returns the deepest any phase has gone.
+ */
+
+uint32_t stack_get_high_water( void )
+{
+  return m_high_water;
+}
+
+
+/*
+ * stack_get_base - returns how deep the stack already was when the last phase
+ *                  began; anything beyond that was the phase's own doing.
+ */
+
+uint32_t stack_get_base( void )
+{
+  return m_base;
+}
+
+
+/*
+ * stack_get_size - returns the total size of the stack being measured.
+ */
+
+uint32_t stack_get_size( void )
+{
+  return m_have_region ? m_region.top - m_region.bottom : 0;
+}
+
+
+/* End of file utils/stack.cpp */
@@ -0,0 +1,69 @@
+/*
+ * utils/stack.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file defines the stack meter; unused stack is painted with a known
+ * pattern, and after a phase of the frame has run we look for how far down
+ * the pattern was disturbed. That gives the deepest the stack has ever been,
+ * measured from its top, for every state and phase.
+ *
+ * On the device, the stacks are the ones the linker script lays out for each
+ * core; on the host, it's whatever the calling thread was given, and only a
+ * window below the current frame is painted, as thread stacks are huge.
+ *
+ * The STACK_ macros compile away to nothing unless PICOVADERS_STACK is
+ * defined, which DEBUG and host builds do; even then, nothing is painted
+ * until stack_enable() is called.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#if ( defined(DEBUG) || defined(PICOVADERS_HOST) ) && !defined(PICOVADERS_STACK)
+#define PICOVADERS_STACK 1
+#endif
+
+#define STACK_PATTERN       0xdeadbeef
+#define STACK_MARGIN        256
+#define STACK_HOST_WINDOW   ( 64 * 1024 )
+
+typedef enum
+{
+  STACK_UPDATE,
+  STACK_DRAW,
+  STACK_PHASE_MAX
+} stackphase_t;
+
+struct stack_region_t
+{
+  uint8_t    *bottom;
+  uint8_t    *top;
+};
+
+bool        stack_current_region( stack_region_t & );
+bool        stack_core1_region( stack_region_t & );
+uint8_t    *stack_paint( const stack_region_t & );
+uint32_t    stack_measure( const stack_region_t &, const uint8_t * );
+
+void        stack_enable( bool );
+bool        stack_enabled( void );
+void        stack_begin( void );
+void        stack_end( gamestate_t, stackphase_t );
+uint32_t    stack_get_last( stackphase_t );
+uint32_t    stack_get_max( gamestate_t, stackphase_t );
+uint32_t    stack_get_high_water( void );
+uint32_t    stack_get_base( void );
+uint32_t    stack_get_size( void );
+
+#ifdef PICOVADERS_STACK
+#define STACK_BEGIN()       stack_begin()
+#define STACK_END(s,p)      stack_end( s, p )
+#else
+#define STACK_BEGIN()
+#define STACK_END(s,p)
+#endif
+
+
+/* End of file utils/stack.hpp */
@@ -27,9 +27,12 @@
  * constructor - just initialises things like timers and assets.
  */
 
-ScalableText::ScalableText( const char *p_text, float p_scale )
+ScalableText::ScalableText( const char *p_text, float p_scale, Arena *p_arena )
 {
-  /* Remember the scale we're using. */
+  /* Remember where our buffers come from. */
+  this->m_arena = p_arena;
+
+  /* And the scale we're using. */
   this->set_scale( p_scale );
 
   /* And then set the text, assuming we have any. */
@@ -49,8 +52,8 @@ ScalableText::ScalableText( const char *p_text, float p_scale )
 
 ScalableText::~ScalableText()
 {
-  /* Clean up the buffer, if we've created one. */
-  if ( this->m_buffer != nullptr )
+  /* Clean up the buffer, if we've created one and it isn't the arena's. */
+  if ( this->m_buffer != nullptr && this->m_arena == nullptr )
   {
     delete this->m_buffer;
     this->m_buffer = nullptr;
@@ -63,7 +66,8 @@ ScalableText::~ScalableText()
 
 /*
  * set_text - updates or sets the text used. A new buffer will be allocated
- *            to hold it, sized to fit the text and no more.
+ *            to hold it, sized to fit the text and no more. In an arena, the
+ *            old buffer can't be given back, so text is best set just once.
  */
 
 void ScalableText::set_text( const char *p_text )
@@ -75,13 +79,23 @@ void ScalableText::set_text( const char *p_text )
   /* If the buffer has been previously allocated, clean it up. */
   if ( this->m_buffer != nullptr )
   {
-    delete this->m_buffer;
+    if ( this->m_arena == nullptr )
+    {
+      delete this->m_buffer;
+    }
     this->m_buffer = nullptr;
   }
 
   /* Measure the next text and fetch a buffer for it. */
   picosystem::measure( this->m_text, this->m_text_width, this->m_text_height );
-  this->m_buffer = picosystem::buffer( this->m_text_width, this->m_text_height );
+  if ( this->m_arena != nullptr )
+  {
+    this->m_buffer = this->alloc_buffer( this->m_text_width, this->m_text_height );
+  }
+  else
+  {
+    this->m_buffer = picosystem::buffer( this->m_text_width, this->m_text_height );
+  }
 
   /* Check we have something to draw in! */
   if ( this->m_buffer == nullptr )
@@ -89,8 +103,10 @@ void ScalableText::set_text( const char *p_text )
     return;
   }
 
-  /* Good, just draw it then. */
+  /* Good, just draw it then; solid, because we only keep the alpha when we  */
+  /* blit it, and whatever pen was last left behind could be transparent.   */
   picosystem::target( this->m_buffer );
+  picosystem::pen( 15, 15, 15 );
   picosystem::text( this->m_text );
   picosystem::target();
 
@@ -99,6 +115,37 @@ void ScalableText::set_text( const char *p_text )
 }
 
 
+/*
+ * alloc_buffer - carves a cleared buffer, and the structure describing it,
+ *                out of our arena; returns nullptr if it won't fit.
+ */
+
+picosystem::buffer_t *ScalableText::alloc_buffer( int32_t p_width, int32_t p_height )
+{
+  picosystem::buffer_t *l_buffer;
+  picosystem::color_t  *l_data;
+
+  /* Both the pixels and the buffer itself come out of the arena. */
+  l_data = (picosystem::color_t *)this->m_arena->alloc( p_width * p_height * sizeof( picosystem::color_t ),
+                                                        alignof( picosystem::color_t ) );
+  l_buffer = this->m_arena->make<picosystem::buffer_t>();
+  if ( l_data == nullptr || l_buffer == nullptr )
+  {
+    return nullptr;
+  }
+
+  /* Start clear, as a fresh SDK buffer would. */
+  memset( l_data, 0, p_width * p_height * sizeof( picosystem::color_t ) );
+  l_buffer->w = p_width;
+  l_buffer->h = p_height;
+  l_buffer->data = l_data;
+  l_buffer->alloc = false;
+
+  /* All done. */
+  return l_buffer;
+}
+
+
 /*
  * set_scale - updates or set the scale at which the text will be drawn.
  */
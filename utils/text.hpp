@@ -6,25 +6,33 @@
  * PicoSystem API text handling, to allow us to arbitarily scale it. Because
  * it's just done through blit scaling, it probably works best as integer scales.
  *
+ * Given an Arena, the text buffer is taken from that rather than the heap; the
+ * buffer then belongs to the arena, and is only released along with it.
+ *
  * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
  * This file is distributed under the MIT License; see LICENSE for details.
  */
 
 #pragma once
 
+#include "utils/arena.hpp"
+
 #define SCALABLETEXT_MAX_LEN  50
 
 class ScalableText
 {
 private:
   picosystem::buffer_t *m_buffer = nullptr;
+  Arena                *m_arena = nullptr;
   float                 m_scale;
   char                  m_text[SCALABLETEXT_MAX_LEN+1];
   int32_t               m_text_width;
   int32_t               m_text_height;
 
+  picosystem::buffer_t *alloc_buffer( int32_t, int32_t );
+
 public:
-                  ScalableText( const char *, float = 1.0f );
+                  ScalableText( const char *, float = 1.0f, Arena * = nullptr );
                  ~ScalableText();
 
   void            set_text( const char * );
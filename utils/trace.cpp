@@ -0,0 +1,167 @@
+/*
+ * utils/trace.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file implements trace zones; a TRACE_ZONE marks the rest of the enclosing
+ * block as a named span of time, and every span is kept so that a whole run
+ * can be laid out on a timeline (as Chrome trace-event JSON) afterwards.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <cstdio>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/trace.hpp"
+
+
+/* Module variables. */
+
+static trace_event_t  m_events[TRACE_EVENTS];
+static uint32_t       m_event_count;
+static uint32_t       m_dropped_count;
+static bool           m_first_written;
+
+
+/* Functions. */
+
+/*
+ * constructor - opens the zone, noting when it started.
+ */
+
+TraceZone::TraceZone( const char *p_name )
+{
+  /* Just remember who we are, and when we began. */
+  this->m_name = p_name;
+  this->m_start_us = picosystem::time_us();
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * destructor - closes the zone, recording the span it covered.
+ */
+
+TraceZone::~TraceZone()
+{
+  trace_add( this->m_name, this->m_start_us, picosystem::time_us() - this->m_start_us );
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * trace_add - records a completed span. Once the buffer is full, spans are
+ *             counted but dropped, until the buffer is written out and cleared.
+ *             Names are never copied, so must be string literals.
+ */
+
+void trace_add( const char *p_name, uint32_t p_start_us, uint32_t p_duration_us )
+{
+  /* If we're full, we can only count our losses. */
+  if ( m_event_count >= TRACE_EVENTS )
+  {
+    m_dropped_count++;
+    return;
+  }
+
+  /* Otherwise, just add it onto the end. */
+  m_events[m_event_count].name = p_name;
+  m_events[m_event_count].start_us = p_start_us;
+  m_events[m_event_count].duration_us = p_duration_us;
+  m_event_count++;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * trace_get_count - returns the number of spans currently buffered.
+ */
+
+uint32_t trace_get_count( void )
+{
+  return m_event_count;
+}
+
+
+/*
+ * trace_get_dropped - returns how many spans were lost to a full buffer.
+ */
+
+uint32_t trace_get_dropped( void )
+{
+  return m_dropped_count;
+}
+
+
+/*
+ * trace_clear - empties the buffer, without writing anything.
+ */
+
+void trace_clear( void )
+{
+  m_event_count = 0;
+  return;
+}
+
+
+/*
+ * trace_write_begin - opens a trace-event JSON array on the stream; the
+ *                     events are written out in as many batches as needed
+ *                     after this, and trace_write_end closes it off.
+ */
+
+void trace_write_begin( FILE *p_stream )
+{
+  fprintf( p_stream, "[\n" );
+  m_first_written = false;
+  m_dropped_count = 0;
+  return;
+}
+
+
+/*
+ * trace_write_events - writes out all the buffered spans as complete ('X')
+ *                      events, and empties the buffer ready for more.
+ */
+
+void trace_write_events( FILE *p_stream )
+{
+  for ( uint32_t l_index = 0; l_index < m_event_count; l_index++ )
+  {
+    fprintf( p_stream, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,\"pid\":1,\"tid\":1}",
+             m_first_written ? ",\n" : "", m_events[l_index].name,
+             m_events[l_index].start_us, m_events[l_index].duration_us );
+    m_first_written = true;
+  }
+  m_event_count = 0;
+
+  /* All done. */
+  return;
+}
+
+
+/*
+ * trace_write_end - writes out anything still buffered, and closes the array.
+ */
+
+void trace_write_end( FILE *p_stream )
+{
+  trace_write_events( p_stream );
+  fprintf( p_stream, "\n]\n" );
+  return;
+}
+
+
+/* End of file utils/trace.cpp */
@@ -0,0 +1,70 @@
+/*
+ * utils/trace.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                  for the PicoSystem.
+ *
+ * This file defines trace zones; a TRACE_ZONE marks the rest of the enclosing
+ * block as a named span of time, and every span is kept so that a whole run
+ * can be laid out on a timeline (as Chrome trace-event JSON) afterwards.
+ *
+ * Zones compile away to nothing unless PICOVADERS_TRACE is defined, which
+ * DEBUG host builds do. Only the host tools ever write zones out, so device
+ * builds never record them, and keep no buffer for them.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+/* System headers. */
+
+#include <cstdio>
+
+
+#if defined(DEBUG) && defined(PICOVADERS_HOST) && !defined(PICOVADERS_TRACE)
+#define PICOVADERS_TRACE 1
+#endif
+
+/* Zones are buffered until the host runner writes them out. */
+#if defined(PICOVADERS_HOST) && defined(PICOVADERS_TRACE)
+#define TRACE_EVENTS        65536
+#else
+#define TRACE_EVENTS        1
+#endif
+
+struct trace_event_t
+{
+  const char *name;
+  uint32_t    start_us;
+  uint32_t    duration_us;
+};
+
+class TraceZone
+{
+private:
+  const char *m_name;
+  uint32_t    m_start_us;
+
+public:
+              TraceZone( const char * );
+             ~TraceZone();
+};
+
+void        trace_add( const char *, uint32_t, uint32_t );
+uint32_t    trace_get_count( void );
+uint32_t    trace_get_dropped( void );
+void        trace_clear( void );
+void        trace_write_begin( FILE * );
+void        trace_write_events( FILE * );
+void        trace_write_end( FILE * );
+
+#ifdef PICOVADERS_TRACE
+#define TRACE_JOIN2(a,b)    a##b
+#define TRACE_JOIN(a,b)     TRACE_JOIN2( a, b )
+#define TRACE_ZONE(n)       TraceZone TRACE_JOIN( l_trace_zone_, __LINE__ )( n )
+#else
+#define TRACE_ZONE(n)
+#endif
+
+
+/* End of file utils/trace.hpp */
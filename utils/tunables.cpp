@@ -0,0 +1,161 @@
+/*
+ * utils/tunables.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                     for the PicoSystem.
+ *
+ * This file implements the tunables registry; names, defaults and ranges are
+ * always available, but values can only be changed in builds where they live
+ * in a table rather than being folded into constants.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <cstdlib>
+#include <cstring>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/tunables.hpp"
+
+
+/* Module variables. */
+
+static const tunable_info_t m_tunables[TUNE_MAX] = {
+#define TUNABLE_INFO(id,name,value,min,max) { name, value, min, max },
+  TUNABLES( TUNABLE_INFO )
+#undef TUNABLE_INFO
+};
+
+#ifdef PICOVADERS_TUNABLES
+int32_t tunable_values[TUNE_MAX] = {
+#define TUNABLE_VALUE(id,name,value,min,max) value,
+  TUNABLES( TUNABLE_VALUE )
+#undef TUNABLE_VALUE
+};
+#endif
+
+
+/* Functions. */
+
+/*
+ * tunable_get_info - returns the name, default and range of a tunable.
+ */
+
+const tunable_info_t *tunable_get_info( tunable_t p_tunable )
+{
+  return p_tunable < TUNE_MAX ? &m_tunables[p_tunable] : nullptr;
+}
+
+
+/*
+ * tunable_find - looks up a tunable by name; returns false if there's no such
+ *                thing.
+ */
+
+bool tunable_find( const char *p_name, tunable_t &p_tunable )
+{
+  uint_fast8_t l_index;
+
+  for ( l_index = 0; l_index < TUNE_MAX; l_index++ )
+  {
+    if ( strcmp( p_name, m_tunables[l_index].name ) == 0 )
+    {
+      p_tunable = (tunable_t)l_index;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+ * tunable_set - changes a tunable, if the build allows it; values outside the
+ *               tunable's range are refused, rather than clamped.
+ */
+
+bool tunable_set( tunable_t p_tunable, int32_t p_value )
+{
+#ifdef PICOVADERS_TUNABLES
+  if ( p_tunable >= TUNE_MAX ||
+       p_value < m_tunables[p_tunable].min || p_value > m_tunables[p_tunable].max )
+  {
+    return false;
+  }
+  tunable_values[p_tunable] = p_value;
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+/*
+ * tunable_parse - sets a tunable from a "name=value" string, as given on a
+ *                 command line.
+ */
+
+bool tunable_parse( const char *p_setting )
+{
+  char        l_name[32];
+  const char *l_equals = strchr( p_setting, '=' );
+  char       *l_end;
+  tunable_t   l_tunable;
+  long        l_value;
+
+  /* Split it up, and make sure both halves make sense. */
+  if ( l_equals == nullptr || l_equals - p_setting >= (long)sizeof( l_name ) )
+  {
+    return false;
+  }
+  memcpy( l_name, p_setting, l_equals - p_setting );
+  l_name[l_equals - p_setting] = '\0';
+
+  l_value = strtol( l_equals + 1, &l_end, 10 );
+  if ( l_end == l_equals + 1 || *l_end != '\0' || !tunable_find( l_name, l_tunable ) )
+  {
+    return false;
+  }
+
+  /* All done. */
+  return tunable_set( l_tunable, (int32_t)l_value );
+}
+
+
+/*
+ * tunable_get - returns the current value of a tunable; game code should use
+ *               TUNABLE() instead, which costs nothing in release builds.
+ */
+
+int32_t tunable_get( tunable_t p_tunable )
+{
+#ifdef PICOVADERS_TUNABLES
+  return p_tunable < TUNE_MAX ? tunable_values[p_tunable] : 0;
+#else
+  return p_tunable < TUNE_MAX ? m_tunables[p_tunable].value : 0;
+#endif
+}
+
+
+/*
+ * tunable_reset - puts every tunable back to its default.
+ */
+
+void tunable_reset( void )
+{
+#ifdef PICOVADERS_TUNABLES
+  uint_fast8_t l_index;
+
+  for ( l_index = 0; l_index < TUNE_MAX; l_index++ )
+  {
+    tunable_values[l_index] = m_tunables[l_index].value;
+  }
+#endif
+  return;
+}
+
+
+/* End of file utils/tunables.cpp */
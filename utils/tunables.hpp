@@ -0,0 +1,81 @@
+/*
+ * utils/tunables.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                     for the PicoSystem.
+ *
+ * This file defines the tunables; the numbers which set the pace and load of
+ * the game, each with a name, a default and the range it can sensibly take.
+ *
+ * In DEBUG and host builds (where PICOVADERS_TUNABLES is defined) they live in
+ * a table, and can be changed while the game runs; everywhere else, TUNABLE()
+ * is simply the default, and folds away into a constant.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#if ( defined(DEBUG) || defined(PICOVADERS_HOST) ) && !defined(PICOVADERS_TUNABLES)
+#define PICOVADERS_TUNABLES 1
+#endif
+
+/*
+ * Every tunable, with the name it goes by, its default and its range. The
+ * invader ticker runs at TEMPO_BASE + TEMPO_STEP ms for each invader left, and
+ * CATCHUP_LIMIT caps how often any timer fires in one update (zero for no cap).
+ * The game simulates in fixed steps of SIM_STEP ms, running no more than
+ * SIM_MAX_STEPS of them in one update; any time beyond that is dropped.
+ */
+
+#define TUNABLES(X) \
+  X( INVADER_PERIOD,    "invader_period",    400,  1, 2000 ) \
+  X( BASE_PERIOD,       "base_period",        20,  1, 1000 ) \
+  X( BULLET_PERIOD,     "bullet_period",      10,  1, 1000 ) \
+  X( EXPLOSION_PERIOD,  "explosion_period",  100,  1, 1000 ) \
+  X( TEMPO_BASE,        "tempo_base",         10,  1, 1000 ) \
+  X( TEMPO_STEP,        "tempo_step",          7,  0,  100 ) \
+  X( CELL_PITCH,        "cell_pitch",         20, 16,   24 ) \
+  X( INVADER_STEP,      "invader_step",        2,  1,   10 ) \
+  X( INVADER_DROP,      "invader_drop",       10,  0,   40 ) \
+  X( BULLET_SPEED,      "bullet_speed",        1,  1,   20 ) \
+  X( EXPLOSION_SLOTS,   "explosion_slots",    15,  0,   15 ) \
+  X( CATCHUP_LIMIT,     "catchup_limit",       0,  0,  100 ) \
+  X( SIM_STEP,          "sim_step",           10,  1,  100 ) \
+  X( SIM_MAX_STEPS,     "sim_max_steps",      10,  1,  100 )
+
+typedef enum
+{
+#define TUNABLE_ENUM(id,name,value,min,max) TUNE_##id,
+  TUNABLES( TUNABLE_ENUM )
+#undef TUNABLE_ENUM
+  TUNE_MAX
+} tunable_t;
+
+#define TUNABLE_DEFAULT(id,name,value,min,max) static constexpr int32_t TUNE_DEFAULT_##id = value;
+TUNABLES( TUNABLE_DEFAULT )
+#undef TUNABLE_DEFAULT
+
+struct tunable_info_t
+{
+  const char *name;
+  int32_t     value;
+  int32_t     min;
+  int32_t     max;
+};
+
+const tunable_info_t *tunable_get_info( tunable_t );
+bool        tunable_find( const char *, tunable_t & );
+bool        tunable_set( tunable_t, int32_t );
+bool        tunable_parse( const char * );
+int32_t     tunable_get( tunable_t );
+void        tunable_reset( void );
+
+#ifdef PICOVADERS_TUNABLES
+extern int32_t tunable_values[TUNE_MAX];
+#define TUNABLE(id)         ( tunable_values[TUNE_##id] )
+#else
+#define TUNABLE(id)         ( TUNE_DEFAULT_##id )
+#endif
+
+
+/* End of file utils/tunables.hpp */
@@ -0,0 +1,200 @@
+/*
+ * utils/xip.cpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                for the PicoSystem.
+ *
+ * This file implements the XIP cache model; registered regions are laid out
+ * one after another from the start of flash, and every read of them is split
+ * into cache lines and looked up in a two-way, least recently used cache.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+/* System headers. */
+
+#include <cstring>
+
+
+/* Local headers. */
+
+#include "picosystem.hpp"
+#include "utils/xip.hpp"
+
+
+/* Structures. */
+
+struct xip_region_t
+{
+  const uint8_t  *start;
+  uint32_t        size;
+  uint32_t        flash;
+  const char     *name;
+};
+
+struct xip_set_t
+{
+  uint32_t        tag[XIP_WAYS];
+  bool            valid[XIP_WAYS];
+  uint8_t         lru;            /* The way to replace next. */
+};
+
+
+/* Module variables. */
+
+static xip_region_t m_regions[XIP_MAX_REGIONS];
+static uint32_t     m_region_count;
+static uint32_t     m_next_flash = XIP_BASE;
+static xip_set_t    m_sets[XIP_SETS];
+static xip_stats_t  m_stats;
+
+
+/* Functions. */
+
+/*
+ * xip_add_region - registers an array as living in flash; it's given the next
+ *                  free address, as the linker would. Registering the same
+ *                  array again does nothing.
+ */
+
+void xip_add_region( const void *p_start, uint32_t p_size, const char *p_name )
+{
+  uint32_t l_index;
+
+  for ( l_index = 0; l_index < m_region_count; l_index++ )
+  {
+    if ( m_regions[l_index].start == p_start )
+    {
+      return;
+    }
+  }
+  if ( m_region_count >= XIP_MAX_REGIONS )
+  {
+    return;
+  }
+
+  m_regions[m_region_count].start = (const uint8_t *)p_start;
+  m_regions[m_region_count].size = p_size;
+  m_regions[m_region_count].flash = m_next_flash;
+  m_regions[m_region_count].name = p_name;
+  m_region_count++;
+
+  /* Keep the next one word aligned. */
+  m_next_flash = ( m_next_flash + p_size + 3 ) & ~3U;
+  return;
+}
+
+
+/*
+ * lookup - looks up a single line in the cache, filling it on a miss.
+ */
+
+static void lookup( uint32_t p_line )
+{
+  xip_set_t  &l_set = m_sets[p_line % XIP_SETS];
+  uint32_t    l_tag = p_line / XIP_SETS;
+  uint_fast8_t l_way;
+
+  for ( l_way = 0; l_way < XIP_WAYS; l_way++ )
+  {
+    if ( l_set.valid[l_way] && l_set.tag[l_way] == l_tag )
+    {
+      m_stats.hits++;
+      l_set.lru = ( l_way + 1 ) % XIP_WAYS;
+      return;
+    }
+  }
+
+  /* Missed, so evict the least recently used way. */
+  m_stats.misses++;
+  l_way = l_set.lru;
+  l_set.tag[l_way] = l_tag;
+  l_set.valid[l_way] = true;
+  l_set.lru = ( l_way + 1 ) % XIP_WAYS;
+  return;
+}
+
+
+/*
+ * xip_read - feeds a read through the cache, if it falls within a registered
+ *            region; anything else is assumed to be in RAM, and ignored.
+ */
+
+void xip_read( const void *p_address, uint32_t p_length )
+{
+  const uint8_t *l_address = (const uint8_t *)p_address;
+  uint32_t       l_index, l_first, l_last, l_line;
+
+  if ( p_length == 0 )
+  {
+    return;
+  }
+
+  for ( l_index = 0; l_index < m_region_count; l_index++ )
+  {
+    const xip_region_t &l_region = m_regions[l_index];
+    if ( l_address < l_region.start || l_address >= l_region.start + l_region.size )
+    {
+      continue;
+    }
+
+    /* Translate to flash, and touch every line the read spans. */
+    l_first = l_region.flash + ( l_address - l_region.start );
+    l_last = l_first + p_length - 1;
+    for ( l_line = l_first / XIP_LINE_SIZE; l_line <= l_last / XIP_LINE_SIZE; l_line++ )
+    {
+      lookup( l_line );
+    }
+    m_stats.bytes += p_length;
+    return;
+  }
+}
+
+
+/*
+ * xip_flush - empties the cache, as it is when the device boots.
+ */
+
+void xip_flush( void )
+{
+  memset( m_sets, 0, sizeof( m_sets ) );
+}
+
+
+/*
+ * xip_get_stats - returns the running totals; like the render counters, they
+ *                 only go up, so take the difference across what's measured.
+ */
+
+void xip_get_stats( xip_stats_t &p_stats )
+{
+  p_stats = m_stats;
+}
+
+
+/*
+ * xip_stats_delta - works out the counts between two snapshots.
+ */
+
+xip_stats_t xip_stats_delta( const xip_stats_t &p_before, const xip_stats_t &p_after )
+{
+  xip_stats_t l_delta;
+
+  l_delta.bytes = p_after.bytes - p_before.bytes;
+  l_delta.hits = p_after.hits - p_before.hits;
+  l_delta.misses = p_after.misses - p_before.misses;
+  return l_delta;
+}
+
+
+/*
+ * xip_stall_us - estimates how long the core would have stalled on the misses
+ *                counted.
+ */
+
+uint32_t xip_stall_us( const xip_stats_t &p_stats )
+{
+  return (uint64_t)p_stats.misses * XIP_MISS_CYCLES / XIP_CLOCK_MHZ;
+}
+
+
+/* End of file utils/xip.cpp */
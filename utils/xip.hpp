@@ -0,0 +1,62 @@
+/*
+ * utils/xip.hpp; part of PicoVaders, a Space Invaders inspired shoot-em-up
+ *                for the PicoSystem.
+ *
+ * This file defines a model of the RP2040's XIP cache; the assets live in
+ * flash as const arrays, and every read of them on the device goes through a
+ * 16KB, two-way set associative cache with 8 byte lines. A miss stalls the
+ * core while the line is fetched over QSPI.
+ *
+ * Asset arrays are registered as flash regions, and reads of them are fed
+ * through the model, which counts the hits and misses. Only data reads are
+ * modelled; on the device, code fetches share the cache too, so the real
+ * hit rate can only be worse.
+ *
+ * The XIP_ macros compile away to nothing unless PICOVADERS_XIP is defined,
+ * which host builds do.
+ *
+ * Copyright (c) 2022 Pete Favelle <picosystem@ahnlak.com>
+ * This file is distributed under the MIT License; see LICENSE for details.
+ */
+
+#pragma once
+
+#if defined(PICOVADERS_HOST) && !defined(PICOVADERS_XIP)
+#define PICOVADERS_XIP 1
+#endif
+
+#define XIP_BASE          0x10000000
+#define XIP_CACHE_SIZE    ( 16 * 1024 )
+#define XIP_LINE_SIZE     8
+#define XIP_WAYS          2
+#define XIP_SETS          ( XIP_CACHE_SIZE / ( XIP_LINE_SIZE * XIP_WAYS ) )
+#define XIP_MAX_REGIONS   8
+
+/* Rough cost of a miss; a QSPI command, address and 8 bytes of data. */
+#define XIP_MISS_CYCLES   50
+#define XIP_CLOCK_MHZ     125
+
+struct xip_stats_t
+{
+  uint64_t  bytes;                /* Bytes read from flash regions.       */
+  uint32_t  hits;                 /* Cache line lookups that hit ...      */
+  uint32_t  misses;               /* ... and that had to go out to flash. */
+};
+
+void        xip_add_region( const void *, uint32_t, const char * );
+void        xip_read( const void *, uint32_t );
+void        xip_flush( void );
+void        xip_get_stats( xip_stats_t & );
+xip_stats_t xip_stats_delta( const xip_stats_t &, const xip_stats_t & );
+uint32_t    xip_stall_us( const xip_stats_t & );
+
+#ifdef PICOVADERS_XIP
+#define XIP_REGION(p,s,n)   xip_add_region( p, s, n )
+#define XIP_READ(p,s)       xip_read( p, s )
+#else
+#define XIP_REGION(p,s,n)
+#define XIP_READ(p,s)
+#endif
+
+
+/* End of file utils/xip.hpp */